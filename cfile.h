@@ -53,6 +53,9 @@ struct packet_provider_data {
   frame_data  *prev_cap;
   frame_data_sequence *frames;       /* Sequence of frames, if we're keeping that information */
   GTree       *frames_user_comments; /* BST with user comments for frames (key = frame_data) */
+  nstime_t     shift_offset;         /* Time shift offset of frames 1 to shift_offset_frames */
+  guint32      shift_offset_frames;
+  GTree       *frames_shift_offsets; /* BST with time shift offsets that differ from shift_offset (key = frame_data) */
 };
 
 typedef struct _capture_file {
@@ -123,6 +126,10 @@ const char *cap_file_provider_get_interface_name(struct packet_provider_data *pr
 const char *cap_file_provider_get_interface_description(struct packet_provider_data *prov, guint32 interface_id);
 const char *cap_file_provider_get_user_comment(struct packet_provider_data *prov, const frame_data *fd);
 void cap_file_provider_set_user_comment(struct packet_provider_data *prov, frame_data *fd, const char *new_comment);
+const nstime_t *cap_file_provider_get_shift_offset(struct packet_provider_data *prov, const frame_data *fd);
+void cap_file_provider_set_shift_offset(struct packet_provider_data *prov, frame_data *fd, const nstime_t *offset);
+void cap_file_provider_set_shift_offsets(struct packet_provider_data *prov, guint32 count, const nstime_t *offset);
+void cap_file_provider_add_shift_offsets(struct packet_provider_data *prov, guint32 count, const nstime_t *offset);
 
 #ifdef __cplusplus
 }
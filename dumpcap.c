@@ -129,6 +129,8 @@ static gint64 pcap_queue_bytes;
 static gint64 pcap_queue_packets;
 static gint64 pcap_queue_byte_limit = 0;
 static gint64 pcap_queue_packet_limit = 0;
+static gint64 pcap_queue_bytes_max;     /* high-water marks */
+static gint64 pcap_queue_packets_max;
 
 static gboolean capture_child = FALSE; /* FALSE: standalone call, TRUE: this is an Wireshark capture child */
 #ifdef _WIN32
@@ -316,9 +318,24 @@ typedef struct _pcap_queue_element {
         struct pcap_pkthdr  phdr;
         struct pcapng_block_header_s  bh;
     } u;
-    u_char             *pd;
+    u_char             *pd;             /* follows the element in the same allocation */
 } pcap_queue_element;
 
+#define WRITER_THREAD_BATCH 64
+
+/*
+ * Packets taken off pcap_queue by the writer thread with a single lock
+ * round trip.  They stay counted in pcap_queue_bytes and
+ * pcap_queue_packets until the next batch is taken, so the queue limits
+ * apply to them until they've been written.
+ */
+typedef struct _pcap_queue_batch {
+    pcap_queue_element *elements[WRITER_THREAD_BATCH];
+    guint               count;
+    guint               next;
+    gint64              bytes;
+} pcap_queue_batch;
+
 /*
  * Standard secondary message for unexpected errors.
  */
@@ -383,6 +400,8 @@ static void capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_p
 static void capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
                                          const u_char *pd);
 static void capture_loop_write_pcapng_cb(capture_src *pcap_src, const struct pcapng_block_header_s *bh, const u_char *pd);
+static pcap_queue_element *capture_loop_dequeue_packet(pcap_queue_batch *batch, gboolean wait);
+static void capture_loop_write_queue_element(pcap_queue_element *queue_element);
 static void capture_loop_queue_pcapng_cb(capture_src *pcap_src, const struct pcapng_block_header_s *bh, const u_char *pd);
 static void capture_loop_get_errmsg(char *errmsg, int errmsglen, const char *fname,
                                     int err, gboolean is_close);
@@ -2821,6 +2840,19 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
         ld->pdh = ws_fdopen(ld->save_file_fd, "wb");
         if (ld->pdh == NULL) {
             err = errno;
+        } else {
+            /*
+             * Buffer as much as a ringbuffer file does, so that blocks go
+             * out in large writes; we flush before reporting packets to
+             * our parent, and after every dispatch when writing to a pipe.
+             * There's only ever one such file, so the buffer just lives
+             * as long as we do.
+             */
+            static char *save_file_buf = NULL;
+
+            if (save_file_buf == NULL)
+                save_file_buf = (char *)g_malloc(RINGBUFFER_WRITE_BUFFER_SIZE);
+            setvbuf(ld->pdh, save_file_buf, _IOFBF, RINGBUFFER_WRITE_BUFFER_SIZE);
         }
     }
     if (ld->pdh) {
@@ -3472,6 +3504,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     char              secondary_errmsg[MSG_MAX_LENGTH+1];
     capture_src      *pcap_src;
     interface_options *interface_opts;
+    pcap_queue_batch  queue_batch;
     guint             i, error_index        = 0;
 
     *errmsg           = '\0';
@@ -3605,10 +3638,15 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 
     /* WOW, everything is prepared! */
     /* please fasten your seat belts, we will enter now the actual capture loop */
+    queue_batch.count = 0;
+    queue_batch.next = 0;
+    queue_batch.bytes = 0;
     if (use_threads) {
         pcap_queue = g_async_queue_new();
         pcap_queue_bytes = 0;
         pcap_queue_packets = 0;
+        pcap_queue_bytes_max = 0;
+        pcap_queue_packets_max = 0;
         for (i = 0; i < global_ld.pcaps->len; i++) {
             pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
             /* XXX - Add an interface name here? */
@@ -3620,38 +3658,9 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
         if (use_threads) {
             pcap_queue_element *queue_element;
 
-            g_async_queue_lock(pcap_queue);
-            queue_element = (pcap_queue_element *)g_async_queue_timeout_pop_unlocked(pcap_queue, WRITER_THREAD_TIMEOUT);
+            queue_element = capture_loop_dequeue_packet(&queue_batch, TRUE);
             if (queue_element) {
-                if (queue_element->pcap_src->from_pcapng) {
-                    pcap_queue_bytes -= queue_element->u.bh.block_total_length;
-                    pcap_queue_packets -= 1;
-                } else {
-                    pcap_queue_bytes -= queue_element->u.phdr.caplen;
-                    pcap_queue_packets -= 1;
-                }
-            }
-            g_async_queue_unlock(pcap_queue);
-            if (queue_element) {
-                if (queue_element->pcap_src->from_pcapng) {
-                    g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
-                        "Dequeued a block of length %d captured on interface %d.",
-                        queue_element->u.bh.block_total_length, queue_element->pcap_src->interface_id);
-
-                    capture_loop_write_pcapng_cb(queue_element->pcap_src,
-                                                &queue_element->u.bh,
-                                                queue_element->pd);
-                } else {
-                    g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
-                        "Dequeued a packet of length %d captured on interface %d.",
-                        queue_element->u.phdr.caplen, queue_element->pcap_src->interface_id);
-
-                    capture_loop_write_packet_cb((u_char *) queue_element->pcap_src,
-                                                &queue_element->u.phdr,
-                                                queue_element->pd);
-                }
-                g_free(queue_element->pd);
-                g_free(queue_element);
+                capture_loop_write_queue_element(queue_element);
                 inpkts = 1;
             } else {
                 inpkts = 0;
@@ -3774,30 +3783,16 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
             g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO, "Thread of interface %u terminated.",
                   pcap_src->interface_id);
         }
-        while (1) {
-            g_async_queue_lock(pcap_queue);
-            queue_element = (pcap_queue_element *)g_async_queue_try_pop_unlocked(pcap_queue);
-            if (queue_element) {
-                pcap_queue_bytes -= queue_element->u.phdr.caplen;
-                pcap_queue_packets -= 1;
-            }
-            g_async_queue_unlock(pcap_queue);
-            if (queue_element == NULL) {
-                break;
-            }
-            g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
-                  "Dequeued a packet of length %d captured on interface %d.",
-                  queue_element->u.phdr.caplen, queue_element->pcap_src->interface_id);
-            capture_loop_write_packet_cb((u_char *)queue_element->pcap_src,
-                                         &queue_element->u.phdr,
-                                         queue_element->pd);
-            g_free(queue_element->pd);
-            g_free(queue_element);
+        while ((queue_element = capture_loop_dequeue_packet(&queue_batch, FALSE)) != NULL) {
+            capture_loop_write_queue_element(queue_element);
             global_ld.inpkts_to_sync_pipe += 1;
             if (capture_opts->output_to_pipe) {
                 fflush(global_ld.pdh);
             }
         }
+        g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
+              "Queue high-water mark was %" G_GINT64_MODIFIER "d bytes (%" G_GINT64_MODIFIER "d packets)",
+              pcap_queue_bytes_max, pcap_queue_packets_max);
     }
 
 
@@ -4056,7 +4051,6 @@ capture_loop_write_pcapng_cb(capture_src *pcap_src, const struct pcapng_block_he
                                        bh->block_total_length,
                                        &global_ld.bytes_written, &err);
 
-        fflush(global_ld.pdh);
         if (!successful) {
             global_ld.go = FALSE;
             global_ld.err = err;
@@ -4137,6 +4131,78 @@ capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
     }
 }
 
+/* the number of bytes a queued packet or block counts for in pcap_queue_bytes */
+static gint64
+pcap_queue_element_length(const pcap_queue_element *queue_element)
+{
+    if (queue_element->pcap_src->from_pcapng)
+        return queue_element->u.bh.block_total_length;
+    return queue_element->u.phdr.caplen;
+}
+
+/*
+ * Get the next queued packet for the writer thread, waiting for up to
+ * WRITER_THREAD_TIMEOUT for one if wait is TRUE.  Packets are taken off
+ * the queue WRITER_THREAD_BATCH at a time, rather than taking the queue
+ * lock once per packet.
+ */
+static pcap_queue_element *
+capture_loop_dequeue_packet(pcap_queue_batch *batch, gboolean wait)
+{
+    pcap_queue_element *queue_element;
+
+    if (batch->next < batch->count)
+        return batch->elements[batch->next++];
+
+    g_async_queue_lock(pcap_queue);
+    /* The previous batch has been written now */
+    pcap_queue_bytes -= batch->bytes;
+    pcap_queue_packets -= batch->count;
+    batch->count = 0;
+    batch->next = 0;
+    batch->bytes = 0;
+    if (wait)
+        queue_element = (pcap_queue_element *)g_async_queue_timeout_pop_unlocked(pcap_queue, WRITER_THREAD_TIMEOUT);
+    else
+        queue_element = (pcap_queue_element *)g_async_queue_try_pop_unlocked(pcap_queue);
+    while (queue_element != NULL) {
+        batch->elements[batch->count++] = queue_element;
+        batch->bytes += pcap_queue_element_length(queue_element);
+        if (batch->count == WRITER_THREAD_BATCH)
+            break;
+        queue_element = (pcap_queue_element *)g_async_queue_try_pop_unlocked(pcap_queue);
+    }
+    g_async_queue_unlock(pcap_queue);
+
+    if (batch->count == 0)
+        return NULL;
+    return batch->elements[batch->next++];
+}
+
+/* write a packet or block taken off the queue, and free it */
+static void
+capture_loop_write_queue_element(pcap_queue_element *queue_element)
+{
+    if (queue_element->pcap_src->from_pcapng) {
+        g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
+            "Dequeued a block of length %d captured on interface %d.",
+            queue_element->u.bh.block_total_length, queue_element->pcap_src->interface_id);
+
+        capture_loop_write_pcapng_cb(queue_element->pcap_src,
+                                    &queue_element->u.bh,
+                                    queue_element->pd);
+    } else {
+        g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
+            "Dequeued a packet of length %d captured on interface %d.",
+            queue_element->u.phdr.caplen, queue_element->pcap_src->interface_id);
+
+        capture_loop_write_packet_cb((u_char *) queue_element->pcap_src,
+                                    &queue_element->u.phdr,
+                                    queue_element->pd);
+    }
+    g_free(queue_element);
+}
+
 /* one packet was captured, queue it */
 static void
 capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
@@ -4154,19 +4220,15 @@ capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
         return;
     }
 
-    queue_element = (pcap_queue_element *)g_malloc(sizeof(pcap_queue_element));
+    /* One allocation for the element and the packet data */
+    queue_element = (pcap_queue_element *)g_try_malloc(sizeof(pcap_queue_element) + phdr->caplen);
     if (queue_element == NULL) {
        pcap_src->dropped++;
        return;
     }
     queue_element->pcap_src = pcap_src;
     queue_element->u.phdr = *phdr;
-    queue_element->pd = (u_char *)g_malloc(phdr->caplen);
-    if (queue_element->pd == NULL) {
-        pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
+    queue_element->pd = (u_char *)(queue_element + 1);
     memcpy(queue_element->pd, pd, phdr->caplen);
     g_async_queue_lock(pcap_queue);
     if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
@@ -4175,13 +4237,16 @@ capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
         g_async_queue_push_unlocked(pcap_queue, queue_element);
         pcap_queue_bytes += phdr->caplen;
         pcap_queue_packets += 1;
+        if (pcap_queue_bytes > pcap_queue_bytes_max)
+            pcap_queue_bytes_max = pcap_queue_bytes;
+        if (pcap_queue_packets > pcap_queue_packets_max)
+            pcap_queue_packets_max = pcap_queue_packets;
     } else {
         limit_reached = TRUE;
     }
     g_async_queue_unlock(pcap_queue);
     if (limit_reached) {
         pcap_src->dropped++;
-        g_free(queue_element->pd);
         g_free(queue_element);
         g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
               "Dropped a packet of length %d captured on interface %u.",
@@ -4214,19 +4279,15 @@ capture_loop_queue_pcapng_cb(capture_src *pcap_src, const struct pcapng_block_he
         return;
     }
 
-    queue_element = (pcap_queue_element *)g_malloc(sizeof(pcap_queue_element));
+    /* One allocation for the element and the block data */
+    queue_element = (pcap_queue_element *)g_try_malloc(sizeof(pcap_queue_element) + bh->block_total_length);
     if (queue_element == NULL) {
        pcap_src->dropped++;
        return;
     }
     queue_element->pcap_src = pcap_src;
     queue_element->u.bh = *bh;
-    queue_element->pd = (u_char *)g_malloc(bh->block_total_length);
-    if (queue_element->pd == NULL) {
-        pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
+    queue_element->pd = (u_char *)(queue_element + 1);
     memcpy(queue_element->pd, pd, bh->block_total_length);
     g_async_queue_lock(pcap_queue);
     if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
@@ -4235,13 +4296,16 @@ capture_loop_queue_pcapng_cb(capture_src *pcap_src, const struct pcapng_block_he
         g_async_queue_push_unlocked(pcap_queue, queue_element);
         pcap_queue_bytes += bh->block_total_length;
         pcap_queue_packets += 1;
+        if (pcap_queue_bytes > pcap_queue_bytes_max)
+            pcap_queue_bytes_max = pcap_queue_bytes;
+        if (pcap_queue_packets > pcap_queue_packets_max)
+            pcap_queue_packets_max = pcap_queue_packets;
     } else {
         limit_reached = TRUE;
     }
     g_async_queue_unlock(pcap_queue);
     if (limit_reached) {
         pcap_src->dropped++;
-        g_free(queue_element->pd);
         g_free(queue_element);
         g_log(LOG_DOMAIN_CAPTURE_CHILD, G_LOG_LEVEL_INFO,
               "Dropped a packet of length %d captured on interface %u.",
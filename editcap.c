@@ -99,22 +99,52 @@ struct select_item {
 
 /*
  * Duplicate frame detection
+ *
+ * The last dup_window frames are kept in the fd_hash[] ring, in arrival
+ * order, so that the oldest one can be dropped when a new one comes in.
+ * Every distinct (length, digest) pair in the ring also has an entry in
+ * fd_hash_set, counting how many ring entries have it, so checking a
+ * frame against the whole window is a single hash table lookup.
  */
+typedef struct _fd_hash_set_entry_t {
+    guint8     digest[16];
+    guint32    len;
+    guint32    count;       /* Number of fd_hash[] entries with this digest */
+    nstime_t   frame_time;  /* Time of the most recently added one */
+} fd_hash_set_entry_t;
+
 typedef struct _fd_hash_t {
     guint8     digest[16];
     guint32    len;
     nstime_t   frame_time;
+    fd_hash_set_entry_t *set_entry;
 } fd_hash_t;
 
 #define DEFAULT_DUP_DEPTH       5   /* Used with -d */
-#define MAX_DUP_DEPTH     1000000   /* the maximum window (and actual size of fd_hash[]) for de-duplication */
+#define MAX_DUP_DEPTH      G_MAXINT /* the maximum window for de-duplication */
+#define DUP_TIME_DEPTH    1000000   /* the number of frames searched with -w */
 
-static fd_hash_t fd_hash[MAX_DUP_DEPTH];
-static int       dup_window    = DEFAULT_DUP_DEPTH;
-static int       cur_dup_entry = 0;
+static fd_hash_t  *fd_hash       = NULL;  /* grown as needed, up to dup_window */
+static int         fd_hash_size  = 0;
+static GHashTable *fd_hash_set   = NULL;
+static int         dup_window    = DEFAULT_DUP_DEPTH;
+static int         cur_dup_entry = 0;
 
 static guint32   ignored_bytes  = 0;  /* Used with -I */
 
+/* Byte ranges to mask out of the digest, used with --ignore-range */
+struct ignored_range {
+    guint32 first, last;
+};
+
+#define MAX_IGNORED_RANGES 64
+static struct ignored_range   ignored_ranges[MAX_IGNORED_RANGES];
+static guint                  num_ignored_ranges = 0;
+static guint8                *ignored_range_buf  = NULL;
+static guint32                ignored_range_buf_len = 0;
+
+#define LONGOPT_IGNORE_RANGE 0x8101
+
 #define ONE_BILLION 1000000000
 
 /* Weights of different errors we can introduce */
@@ -573,156 +603,237 @@ remove_vlan_info(const wtap_packet_header *phdr, guint8* fd, guint32* len) {
     }
 }
 
+/* Add a byte range to ignore during duplicate detection */
 static gboolean
-is_duplicate(guint8* fd, guint32 len) {
-    int i;
+add_ignored_range(char *range)
+{
+    char *locn;
 
-    /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
-    guint32 offset = ignored_bytes;
-    guint32 new_len;
-    guint8 *new_fd;
+    if (num_ignored_ranges >= MAX_IGNORED_RANGES) {
+        fprintf(stderr, "editcap: Out of room for ignored byte ranges.\n");
+        return FALSE;
+    }
 
-    if (len <= ignored_bytes) {
-        offset = 0;
+    if ((locn = strchr(range, '-')) == NULL) { /* No dash, so a single byte */
+        ignored_ranges[num_ignored_ranges].first = get_guint32(range, "ignored byte offset");
+        ignored_ranges[num_ignored_ranges].last = ignored_ranges[num_ignored_ranges].first;
+    } else {
+        *locn = '\0';    /* split the range */
+        ignored_ranges[num_ignored_ranges].first = get_guint32(range, "beginning of ignored byte range");
+        ignored_ranges[num_ignored_ranges].last = get_guint32(locn + 1, "end of ignored byte range");
+        if (ignored_ranges[num_ignored_ranges].last < ignored_ranges[num_ignored_ranges].first) {
+            fprintf(stderr, "editcap: The ignored byte range %u-%u ends before it starts.\n",
+                    ignored_ranges[num_ignored_ranges].first,
+                    ignored_ranges[num_ignored_ranges].last);
+            return FALSE;
+        }
     }
 
-    new_fd  = &fd[offset];
-    new_len = len - (offset);
+    num_ignored_ranges++;
+    return TRUE;
+}
+
+static guint
+fd_hash_set_hash(gconstpointer key)
+{
+    const fd_hash_set_entry_t *entry = (const fd_hash_set_entry_t *)key;
+    guint32 hash;
+
+    /* The digest is already uniformly distributed */
+    memcpy(&hash, entry->digest, sizeof hash);
+    return hash ^ entry->len;
+}
+
+static gboolean
+fd_hash_set_equal(gconstpointer a, gconstpointer b)
+{
+    const fd_hash_set_entry_t *entry_a = (const fd_hash_set_entry_t *)a;
+    const fd_hash_set_entry_t *entry_b = (const fd_hash_set_entry_t *)b;
+
+    return entry_a->len == entry_b->len
+        && memcmp(entry_a->digest, entry_b->digest, 16) == 0;
+}
+
+static void
+fd_hash_set_free(gpointer data)
+{
+    g_slice_free(fd_hash_set_entry_t, data);
+}
+
+static void
+fd_hash_init(void)
+{
+    fd_hash_set = g_hash_table_new_full(fd_hash_set_hash, fd_hash_set_equal,
+                                        NULL, fd_hash_set_free);
+}
+
+static void
+fd_hash_cleanup(void)
+{
+    if (fd_hash_set) {
+        g_hash_table_destroy(fd_hash_set);
+        fd_hash_set = NULL;
+    }
+    g_free(fd_hash);
+    fd_hash = NULL;
+    fd_hash_size = 0;
+    g_free(ignored_range_buf);
+    ignored_range_buf = NULL;
+    ignored_range_buf_len = 0;
+}
+
+/*
+ * Advance to the next fd_hash[] entry, dropping the frame that was there
+ * from the window.  The ring is grown on demand, so that a huge window
+ * only costs memory for the frames actually seen.
+ */
+static fd_hash_t *
+fd_hash_next_entry(void)
+{
+    fd_hash_t *entry;
 
     cur_dup_entry++;
     if (cur_dup_entry >= dup_window)
         cur_dup_entry = 0;
 
-    /* Calculate our digest */
-    gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
-
-    fd_hash[cur_dup_entry].len = len;
-
-    /* Look for duplicates */
-    for (i = 0; i < dup_window; i++) {
-        if (i == cur_dup_entry)
-            continue;
+    if (cur_dup_entry >= fd_hash_size) {
+        int new_size = fd_hash_size ? fd_hash_size : 1024;
+        int max_size = dup_window > 0 ? dup_window : 1;
+
+        while (new_size <= cur_dup_entry && new_size < G_MAXINT / 2)
+            new_size *= 2;
+        if (new_size > max_size || new_size <= cur_dup_entry)
+            new_size = max_size;
+        fd_hash = g_renew(fd_hash_t, fd_hash, new_size);
+        memset(&fd_hash[fd_hash_size], 0, (new_size - fd_hash_size) * sizeof(fd_hash_t));
+        fd_hash_size = new_size;
+    }
 
-        if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-            && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
-        }
+    entry = &fd_hash[cur_dup_entry];
+    if (entry->set_entry) {
+        if (--entry->set_entry->count == 0)
+            g_hash_table_remove(fd_hash_set, entry->set_entry);
+        entry->set_entry = NULL;
     }
 
-    return FALSE;
+    return entry;
 }
 
-static gboolean
-is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
-    int i;
-
+/* Calculate the digest of a frame, leaving out the bytes to ignore */
+static void
+fd_hash_digest(fd_hash_t *entry, guint8* fd, guint32 len)
+{
     /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
     guint32 offset = ignored_bytes;
     guint32 new_len;
     guint8 *new_fd;
+    guint   i;
 
     if (len <= ignored_bytes) {
         offset = 0;
     }
 
+    if (num_ignored_ranges > 0) {
+        /* Mask out the ignored ranges in a copy (--ignore-range option) */
+        if (len > ignored_range_buf_len) {
+            ignored_range_buf = (guint8 *)g_realloc(ignored_range_buf, len);
+            ignored_range_buf_len = len;
+        }
+        memcpy(ignored_range_buf, fd, len);
+        for (i = 0; i < num_ignored_ranges; i++) {
+            if (ignored_ranges[i].first >= len)
+                continue;
+            if (ignored_ranges[i].last >= len)
+                memset(&ignored_range_buf[ignored_ranges[i].first], 0, len - ignored_ranges[i].first);
+            else
+                memset(&ignored_range_buf[ignored_ranges[i].first], 0,
+                       ignored_ranges[i].last - ignored_ranges[i].first + 1);
+        }
+        fd = ignored_range_buf;
+    }
+
     new_fd  = &fd[offset];
     new_len = len - (offset);
 
-    cur_dup_entry++;
-    if (cur_dup_entry >= dup_window)
-        cur_dup_entry = 0;
+    gcry_md_hash_buffer(GCRY_MD_MD5, entry->digest, new_fd, new_len);
+    entry->len = len;
+}
 
-    /* Calculate our digest */
-    gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
+/*
+ * Add the current fd_hash[] entry to fd_hash_set.  Returns the set entry
+ * as it was *before* this frame was added, or NULL if no frame in the
+ * window had the same length and digest.
+ */
+static fd_hash_set_entry_t *
+fd_hash_add(fd_hash_t *entry, fd_hash_set_entry_t *prev)
+{
+    fd_hash_set_entry_t  key;
+    fd_hash_set_entry_t *set_entry;
+
+    memcpy(key.digest, entry->digest, 16);
+    key.len = entry->len;
 
-    fd_hash[cur_dup_entry].len = len;
-    fd_hash[cur_dup_entry].frame_time.secs = current->secs;
-    fd_hash[cur_dup_entry].frame_time.nsecs = current->nsecs;
+    set_entry = (fd_hash_set_entry_t *)g_hash_table_lookup(fd_hash_set, &key);
+    if (set_entry) {
+        *prev = *set_entry;
+    } else {
+        set_entry = g_slice_new(fd_hash_set_entry_t);
+        *set_entry = key;
+        set_entry->count = 0;
+        g_hash_table_insert(fd_hash_set, set_entry, set_entry);
+    }
+
+    set_entry->count++;
+    set_entry->frame_time = entry->frame_time;
+    entry->set_entry = set_entry;
+
+    return set_entry->count > 1 ? prev : NULL;
+}
+
+static gboolean
+is_duplicate(guint8* fd, guint32 len) {
+    fd_hash_t           *entry;
+    fd_hash_set_entry_t  prev;
+
+    entry = fd_hash_next_entry();
+    fd_hash_digest(entry, fd, len);
+
+    /* Look for duplicates */
+    return fd_hash_add(entry, &prev) != NULL;
+}
+
+static gboolean
+is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
+    fd_hash_t           *entry;
+    fd_hash_set_entry_t  prev;
+    nstime_t             delta;
+
+    entry = fd_hash_next_entry();
+    fd_hash_digest(entry, fd, len);
+    entry->frame_time.secs = current->secs;
+    entry->frame_time.nsecs = current->nsecs;
 
     /*
      * Look for relative time related duplicates.
-     * This is hopefully a reasonably efficient mechanism for
-     * finding duplicates by rel time in the fd_hash[] cache.
-     * We check starting from the most recently added hash
-     * entries and work backwards towards older packets.
-     * This approach allows the dup test to be terminated
-     * when the relative time of a cached entry is found to
-     * be beyond the dup time window.
+     * Only the most recent frame in the fd_hash[] cache with the same
+     * length and digest needs to be checked: if it's not within the
+     * dup time window, no older one is either.
      *
      * Of course this assumes that the input trace file is
      * "well-formed" in the sense that the packet timestamps are
      * in strict chronologically increasing order (which is NOT
-     * always the case!!).
-     *
-     * The fd_hash[] table was deliberately created large (1,000,000).
-     * Looking for time related duplicates in large trace files with
-     * non-fractional dup time window values can potentially take
-     * a long time to complete.
+     * always the case!!).  A frame with an earlier timestamp than
+     * its most recent match is not treated as a duplicate.
      */
+    if (fd_hash_add(entry, &prev) == NULL)
+        return FALSE;
 
-    for (i = cur_dup_entry - 1;; i--) {
-        nstime_t delta;
-        int cmp;
-
-        if (i < 0)
-            i = dup_window - 1;
-
-        if (i == cur_dup_entry) {
-            /*
-             * We've decremented back to where we started.
-             * Check no more!
-             */
-            break;
-        }
-
-        if (nstime_is_unset(&(fd_hash[i].frame_time))) {
-            /*
-             * We've decremented to an unused fd_hash[] entry.
-             * Check no more!
-             */
-            break;
-        }
-
-        nstime_delta(&delta, current, &fd_hash[i].frame_time);
-
-        if (delta.secs < 0 || delta.nsecs < 0) {
-            /*
-             * A negative delta implies that the current packet
-             * has an absolute timestamp less than the cached packet
-             * that it is being compared to.  This is NOT a normal
-             * situation since trace files usually have packets in
-             * chronological order (oldest to newest).
-             *
-             * There are several possible ways to deal with this:
-             * 1. 'continue' dup checking with the next cached frame.
-             * 2. 'break' from looking for a duplicate of the current frame.
-             * 3. Take the absolute value of the delta and see if that
-             * falls within the specifed dup time window.
-             *
-             * Currently this code does option 1.  But it would pretty
-             * easy to add yet-another-editcap-option to select one of
-             * the other behaviors for dealing with out-of-sequence
-             * packets.
-             */
-            continue;
-        }
-
-        cmp = nstime_cmp(&delta, &relative_time_window);
+    nstime_delta(&delta, current, &prev.frame_time);
 
-        if (cmp > 0) {
-            /*
-             * The delta time indicates that we are now looking at
-             * cached packets beyond the specified dup time window.
-             * Check no more!
-             */
-            break;
-        } else if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-                   && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
-        }
-    }
+    if (delta.secs < 0 || delta.nsecs < 0)
+        return FALSE;
 
-    return FALSE;
+    return nstime_cmp(&delta, &relative_time_window) <= 0;
 }
 
 static void
@@ -746,6 +857,7 @@ print_usage(FILE *output)
     fprintf(output, "  -d                     remove packet if duplicate (window == %d).\n", DEFAULT_DUP_DEPTH);
     fprintf(output, "  -D <dup window>        remove packet if duplicate; configurable <dup window>.\n");
     fprintf(output, "                         Valid <dup window> values are 0 to %d.\n", MAX_DUP_DEPTH);
+    fprintf(output, "                         Memory use grows with the number of packets held.\n");
     fprintf(output, "                         NOTE: A <dup window> of 0 with -v (verbose option) is\n");
     fprintf(output, "                         useful to print MD5 hashes.\n");
     fprintf(output, "  -w <dup time window>   remove packet if duplicate packet is found EQUAL TO OR\n");
@@ -762,6 +874,12 @@ print_usage(FILE *output)
     fprintf(output, "                         example).\n");
     fprintf(output, "                         e.g. -I 26 in case of Ether/IP will ignore\n");
     fprintf(output, "                         ether(14) and IP header(20 - 4(src ip) - 4(dst ip)).\n");
+    fprintf(output, "  --ignore-range <first>[-<last>]\n");
+    fprintf(output, "                         ignore the bytes from offset <first> to <last>\n");
+    fprintf(output, "                         (inclusive, starting at 0) during MD5 hash\n");
+    fprintf(output, "                         calculation. May be given more than once.\n");
+    fprintf(output, "                         e.g. --ignore-range 22 --ignore-range 24-25 in case\n");
+    fprintf(output, "                         of Ether/IPv4 will ignore the TTL and the checksum.\n");
     fprintf(output, "\n");
     fprintf(output, "           NOTE: The use of the 'Duplicate packet removal' options with\n");
     fprintf(output, "           other editcap options except -v may not always work as expected.\n");
@@ -952,6 +1070,7 @@ main(int argc, char *argv[])
     int           opt;
     static const struct option long_options[] = {
         {"novlan", no_argument, NULL, 0x8100},
+        {"ignore-range", required_argument, NULL, LONGOPT_IGNORE_RANGE},
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'V'},
         {0, 0, 0, 0 }
@@ -1043,6 +1162,15 @@ main(int argc, char *argv[])
             break;
         }
 
+        case LONGOPT_IGNORE_RANGE:
+        {
+            if (!add_ignored_range(optarg)) {
+                ret = INVALID_OPTION;
+                goto clean_exit;
+            }
+            break;
+        }
+
         case 'a':
         {
             guint frame_number;
@@ -1151,16 +1279,21 @@ main(int argc, char *argv[])
             break;
 
         case 'D':
+        {
+            guint32 window;
+
             dup_detect = TRUE;
             dup_detect_by_time = FALSE;
-            dup_window = get_guint32(optarg, "duplicate window");
-            if (dup_window > MAX_DUP_DEPTH) {
-                fprintf(stderr, "editcap: \"%d\" duplicate window value must be between 0 and %d inclusive.\n",
-                        dup_window, MAX_DUP_DEPTH);
+            window = get_guint32(optarg, "duplicate window");
+            if (window > MAX_DUP_DEPTH) {
+                fprintf(stderr, "editcap: \"%u\" duplicate window value must be between 0 and %d inclusive.\n",
+                        window, MAX_DUP_DEPTH);
                 ret = INVALID_OPTION;
                 goto clean_exit;
             }
+            dup_window = (int)window;
             break;
+        }
 
         case 'E':
             err_prob = g_ascii_strtod(optarg, &p);
@@ -1259,7 +1392,7 @@ main(int argc, char *argv[])
         case 'w':
             dup_detect = FALSE;
             dup_detect_by_time = TRUE;
-            dup_window = MAX_DUP_DEPTH;
+            dup_window = DUP_TIME_DEPTH;
             if (!set_rel_time(optarg)) {
                 ret = INVALID_OPTION;
                 goto clean_exit;
@@ -1362,11 +1495,7 @@ main(int argc, char *argv[])
             max_packet_number = G_MAXUINT;
 
         if (dup_detect || dup_detect_by_time) {
-            for (i = 0; i < dup_window; i++) {
-                memset(&fd_hash[i].digest, 0, 16);
-                fd_hash[i].len = 0;
-                nstime_set_unset(&fd_hash[i].frame_time);
-            }
+            fd_hash_init();
         }
 
         /* Read all of the packets in turn */
@@ -1873,6 +2002,7 @@ main(int argc, char *argv[])
     }
 
 clean_exit:
+    fd_hash_cleanup();
     wtap_block_array_free(shb_hdrs);
     wtap_block_array_free(nrb_hdrs);
     g_free(idb_inf);
@@ -52,6 +52,12 @@ static gboolean filters_enabled = TRUE;
  */
 static gboolean tmp_colors_set = FALSE;
 
+/* The enabled filters of color_filter_list, applied together as a set.
+ * Rebuilt on the next packet whenever the list or its filters change. */
+static dfilter_set_t *color_filter_set = NULL;
+static GPtrArray     *color_filter_set_entries = NULL;
+static gboolean       color_filter_set_stale = TRUE;
+
 /* Create a new filter */
 color_filter_t *
 color_filter_new(const gchar *name,          /* The name of the filter to create */
@@ -166,6 +172,7 @@ color_filters_set_tmp(guint8 filt_nr, const gchar *filter, gboolean disabled, gc
                 colorf->filter_text = g_strdup(tmpfilter);
                 colorf->c_colorfilter = compiled_filter;
                 colorf->disabled = ((i!=filt_nr) ? TRUE : disabled);
+                color_filter_set_stale = TRUE;
                 /* Remember that there are now temporary coloring filters set */
                 if( filter )
                     tmp_colors_set = TRUE;
@@ -326,6 +333,7 @@ color_filters_init(gchar** err_msg, color_filter_add_cb_func add_cb)
 {
     /* delete all currently existing filters */
     color_filter_list_delete(&color_filter_list);
+    color_filter_set_stale = TRUE;
 
     /* now try to construct the filters list */
     return color_filters_get(err_msg, add_cb);
@@ -338,6 +346,7 @@ color_filters_reload(gchar** err_msg, color_filter_add_cb_func add_cb)
      * we must keep them until the dissection no longer needs them */
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
     color_filter_list = NULL;
+    color_filter_set_stale = TRUE;
 
     /* now try to construct the filters list */
     return color_filters_get(err_msg, add_cb);
@@ -432,6 +441,7 @@ color_filters_apply(GSList *tmp_cfl, GSList *edit_cfl, gchar** err_msg)
      * we must keep them until the dissection no longer needs them */
     color_filter_deleted_list = g_slist_concat(color_filter_deleted_list, color_filter_list);
     color_filter_list = NULL;
+    color_filter_set_stale = TRUE;
 
     /* clone all list entries from tmp/edit to normal list */
     color_filter_valid_list = NULL;
@@ -495,19 +505,37 @@ color_filters_colorize_packet(epan_dissect_t *edt)
 {
     GSList         *curr;
     color_filter_t *colorf;
+    int             match;
 
     /* If we have color filters, "search" for the matching one. */
     if ((edt->tree != NULL) && (color_filters_used())) {
-        curr = color_filter_list;
-
-        while(curr != NULL) {
-            colorf = (color_filter_t *)curr->data;
-            if ( (!colorf->disabled) &&
-                 (colorf->c_colorfilter != NULL) &&
-                 dfilter_apply_edt(colorf->c_colorfilter, edt)) {
-                return colorf;
+        /*
+         * Apply the enabled filters as a set, so that the fields most
+         * of them test (protocols, flags, ports...) are only read
+         * from the tree once.
+         */
+        if (color_filter_set_stale) {
+            if (color_filter_set == NULL) {
+                color_filter_set = dfilter_set_new();
+                color_filter_set_entries = g_ptr_array_new();
             }
-            curr = g_slist_next(curr);
+            dfilter_set_clear(color_filter_set);
+            g_ptr_array_set_size(color_filter_set_entries, 0);
+
+            for (curr = color_filter_list; curr != NULL; curr = g_slist_next(curr)) {
+                colorf = (color_filter_t *)curr->data;
+                if ( (!colorf->disabled) &&
+                     (colorf->c_colorfilter != NULL) ) {
+                    dfilter_set_add(color_filter_set, colorf->c_colorfilter);
+                    g_ptr_array_add(color_filter_set_entries, colorf);
+                }
+            }
+            color_filter_set_stale = FALSE;
+        }
+
+        match = dfilter_set_apply_first_edt(color_filter_set, edt);
+        if (match >= 0) {
+            return (const color_filter_t *)g_ptr_array_index(color_filter_set_entries, match);
         }
     }
 
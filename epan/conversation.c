@@ -40,6 +40,7 @@ struct conversation_key {
 	endpoint_type etype;
 	guint32	port1;
 	guint32	port2;
+	guint	lookup_hash;	/* precomputed hash value; lookup keys only, 0 if none */
 };
 
 /*
@@ -168,37 +169,74 @@ conversation_create_from_template(conversation_t *conversation, const address *a
 }
 
 /*
- * Compute the hash value for two given address/port pairs if the match
- * is to be exact.
+ * The hash values of all of the conversation tables are built from
+ * hashes of the individual endpoints, so that find_conversation() can
+ * hash the address data of each endpoint once and derive the hash
+ * value for every table and direction it probes from those.
  */
 /* http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx#existing
  * One-at-a-Time hash
  */
-guint
-conversation_hash_exact(gconstpointer v)
+static inline guint
+conversation_hash_finish(guint hash_val)
+{
+	hash_val += ( hash_val << 3 );
+	hash_val ^= ( hash_val >> 11 );
+	hash_val += ( hash_val << 15 );
+
+	return hash_val;
+}
+
+/*
+ * Partial (not yet finished) hash of an address; NULL and AT_NONE
+ * addresses hash to 0.
+ */
+static inline guint
+conversation_hash_address(const address *addr)
+{
+	return addr != NULL ? add_address_to_hash(0, addr) : 0;
+}
+
+/*
+ * Hash of an address/port pair, given the partial hash of the address.
+ */
+static inline guint
+conversation_hash_endpoint(guint addr_hash, guint32 port)
 {
-	const conversation_key_t key = (const conversation_key_t)v;
-	guint hash_val;
 	address tmp_addr;
 
-	hash_val = 0;
 	tmp_addr.len  = 4;
+	tmp_addr.data = &port;
 
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
+	return conversation_hash_finish(add_address_to_hash(addr_hash, &tmp_addr));
+}
 
-	tmp_addr.data = &key->port1;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
+/*
+ * Combine the hash of the first endpoint with the hash of whatever
+ * part of the second endpoint the table matches on.  This isn't
+ * symmetric; lookups probe each direction separately.
+ */
+static inline guint
+conversation_hash_combine(guint hash1, guint hash2)
+{
+	return hash1 ^ (hash2 + 0x9e3779b9 + (hash1 << 6) + (hash1 >> 2));
+}
 
-	hash_val = add_address_to_hash(hash_val, &key->addr2);
+/*
+ * Compute the hash value for two given address/port pairs if the match
+ * is to be exact.
+ */
+guint
+conversation_hash_exact(gconstpointer v)
+{
+	const conversation_key_t key = (const conversation_key_t)v;
 
-	tmp_addr.data = &key->port2;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
+	if (key->lookup_hash != 0)
+		return key->lookup_hash;
 
-	hash_val += ( hash_val << 3 );
-	hash_val ^= ( hash_val >> 11 );
-	hash_val += ( hash_val << 15 );
-
-	return hash_val;
+	return conversation_hash_combine(
+	    conversation_hash_endpoint(conversation_hash_address(&key->addr1), key->port1),
+	    conversation_hash_endpoint(conversation_hash_address(&key->addr2), key->port2));
 }
 
 /*
@@ -261,25 +299,13 @@ static guint
 conversation_hash_no_addr2(gconstpointer v)
 {
 	const conversation_key_t key = (const conversation_key_t)v;
-	guint hash_val;
-	address tmp_addr;
-
-	hash_val = 0;
-	tmp_addr.len  = 4;
 
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
-
-	tmp_addr.data = &key->port1;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
-
-	tmp_addr.data = &key->port2;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
-
-	hash_val += ( hash_val << 3 );
-	hash_val ^= ( hash_val >> 11 );
-	hash_val += ( hash_val << 15 );
+	if (key->lookup_hash != 0)
+		return key->lookup_hash;
 
-	return hash_val;
+	return conversation_hash_combine(
+	    conversation_hash_endpoint(conversation_hash_address(&key->addr1), key->port1),
+	    conversation_hash_endpoint(0, key->port2));
 }
 
 /*
@@ -326,24 +352,13 @@ static guint
 conversation_hash_no_port2(gconstpointer v)
 {
 	const conversation_key_t key = (const conversation_key_t)v;
-	guint hash_val;
-	address tmp_addr;
 
-	hash_val = 0;
-	tmp_addr.len  = 4;
+	if (key->lookup_hash != 0)
+		return key->lookup_hash;
 
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
-
-	tmp_addr.data = &key->port1;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
-
-	hash_val = add_address_to_hash(hash_val, &key->addr2);
-
-	hash_val += ( hash_val << 3 );
-	hash_val ^= ( hash_val >> 11 );
-	hash_val += ( hash_val << 15 );
-
-	return hash_val;
+	return conversation_hash_combine(
+	    conversation_hash_endpoint(conversation_hash_address(&key->addr1), key->port1),
+	    conversation_hash_finish(conversation_hash_address(&key->addr2)));
 }
 
 /*
@@ -390,22 +405,11 @@ static guint
 conversation_hash_no_addr2_or_port2(gconstpointer v)
 {
 	const conversation_key_t key = (const conversation_key_t)v;
-	guint hash_val;
-	address tmp_addr;
 
-	hash_val = 0;
-	tmp_addr.len  = 4;
-
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
+	if (key->lookup_hash != 0)
+		return key->lookup_hash;
 
-	tmp_addr.data = &key->port1;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
-
-	hash_val += ( hash_val << 3 );
-	hash_val ^= ( hash_val >> 11 );
-	hash_val += ( hash_val << 15 );
-
-	return hash_val;
+	return conversation_hash_endpoint(conversation_hash_address(&key->addr1), key->port1);
 }
 
 /*
@@ -652,6 +656,7 @@ conversation_new(const guint32 setup_frame, const address *addr1, const address
 	new_key->etype = etype;
 	new_key->port1 = port1;
 	new_key->port2 = port2;
+	new_key->lookup_hash = 0;
 
 	conversation = wmem_new(wmem_file_scope(), conversation_t);
 	memset(conversation, 0, sizeof(conversation_t));
@@ -754,10 +759,11 @@ conversation_set_addr2(conversation_t *conv, const address *addr)
 
 /*
  * Search a particular hash table for a conversation with the specified
- * {addr1, port1, addr2, port2} and set up before frame_num.
+ * {addr1, port1, addr2, port2} and set up before frame_num.  "hash" is
+ * the hash value of that key for the table.
  */
 static conversation_t *
-conversation_lookup_hashtable(wmem_map_t *hashtable, const guint32 frame_num, const address *addr1, const address *addr2,
+conversation_lookup_hashtable(wmem_map_t *hashtable, const guint hash, const guint32 frame_num, const address *addr1, const address *addr2,
     const endpoint_type etype, const guint32 port1, const guint32 port2)
 {
 	conversation_t* convo=NULL;
@@ -782,6 +788,7 @@ conversation_lookup_hashtable(wmem_map_t *hashtable, const guint32 frame_num, co
 	key.etype = etype;
 	key.port1 = port1;
 	key.port2 = port2;
+	key.lookup_hash = hash;
 
 	chain_head = (conversation_t *)wmem_map_lookup(hashtable, &key);
 
@@ -849,6 +856,16 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
     const guint32 port_a, const guint32 port_b, const guint options)
 {
 	conversation_t *conversation;
+	guint addr_hash_a, addr_hash_b, hash_a, hash_b;
+
+	/*
+	 * Hash the address data of each endpoint once; the hash value
+	 * for each of the lookups below is derived from these.
+	 */
+	addr_hash_a = conversation_hash_address(addr_a);
+	addr_hash_b = conversation_hash_address(addr_b);
+	hash_a = conversation_hash_endpoint(addr_hash_a, port_a);
+	hash_b = conversation_hash_endpoint(addr_hash_b, port_b);
 
 	/*
 	 * First try an exact match, if we have two addresses and ports.
@@ -861,6 +878,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		DPRINT(("trying exact match"));
 		conversation =
 			conversation_lookup_hashtable(conversation_hashtable_exact,
+			conversation_hash_combine(hash_a, hash_b),
 			frame_num, addr_a, addr_b, etype,
 			port_a, port_b);
 		/* Didn't work, try the other direction */
@@ -868,6 +886,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			DPRINT(("trying opposite direction"));
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_exact,
+				conversation_hash_combine(hash_b, hash_a),
 				frame_num, addr_b, addr_a, etype,
 				port_b, port_a);
 		}
@@ -877,6 +896,8 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			 */
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_exact,
+				conversation_hash_combine(conversation_hash_endpoint(addr_hash_b, port_a),
+				    conversation_hash_endpoint(addr_hash_a, port_b)),
 				frame_num, addr_b, addr_a, etype,
 				port_a, port_b);
 		}
@@ -902,6 +923,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		DPRINT(("trying wildcarded dest address"));
 		conversation =
 			conversation_lookup_hashtable(conversation_hashtable_no_addr2,
+			conversation_hash_combine(hash_a, conversation_hash_endpoint(0, port_b)),
 			frame_num, addr_a, addr_b, etype, port_a, port_b);
 		if ((conversation == NULL) && (addr_a->type == AT_FC)) {
 			/* In Fibre channel, OXID & RXID are never swapped as
@@ -909,6 +931,8 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			 */
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2,
+				conversation_hash_combine(conversation_hash_endpoint(addr_hash_b, port_a),
+				    conversation_hash_endpoint(0, port_b)),
 				frame_num, addr_b, addr_a, etype,
 				port_a, port_b);
 		}
@@ -954,6 +978,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			DPRINT(("trying dest addr:port as source addr:port with wildcarded dest addr"));
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2,
+				conversation_hash_combine(hash_b, conversation_hash_endpoint(0, port_a)),
 				frame_num, addr_b, addr_a, etype, port_b, port_a);
 			if (conversation != NULL) {
 				/*
@@ -998,6 +1023,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		DPRINT(("trying wildcarded dest port"));
 		conversation =
 			conversation_lookup_hashtable(conversation_hashtable_no_port2,
+			conversation_hash_combine(hash_a, conversation_hash_finish(addr_hash_b)),
 			frame_num, addr_a, addr_b, etype, port_a, port_b);
 		if ((conversation == NULL) && (addr_a->type == AT_FC)) {
 			/* In Fibre channel, OXID & RXID are never swapped as
@@ -1005,6 +1031,8 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			 */
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_port2,
+				conversation_hash_combine(conversation_hash_endpoint(addr_hash_b, port_a),
+				    conversation_hash_finish(addr_hash_a)),
 				frame_num, addr_b, addr_a, etype, port_a, port_b);
 		}
 		if (conversation != NULL) {
@@ -1049,6 +1077,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 			DPRINT(("trying dest addr:port as source addr:port and wildcarded dest port"));
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_port2,
+				conversation_hash_combine(hash_b, conversation_hash_finish(addr_hash_a)),
 				frame_num, addr_b, addr_a, etype, port_b, port_a);
 			if (conversation != NULL) {
 				/*
@@ -1088,7 +1117,7 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 	DPRINT(("trying wildcarding dest addr:port"));
 	conversation =
 		conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
-		frame_num, addr_a, addr_b, etype, port_a, port_b);
+		hash_a, frame_num, addr_a, addr_b, etype, port_a, port_b);
 	if (conversation != NULL) {
 		/*
 		 * If this is for a connection-oriented protocol:
@@ -1142,11 +1171,12 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		if ((addr_a != NULL) && (addr_a->type == AT_FC))
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
+				conversation_hash_endpoint(addr_hash_b, port_a),
 				frame_num, addr_b, addr_a, etype, port_a, port_b);
 		else
 			conversation =
 				conversation_lookup_hashtable(conversation_hashtable_no_addr2_or_port2,
-				frame_num, addr_b, addr_a, etype, port_b, port_a);
+				hash_b, frame_num, addr_b, addr_a, etype, port_b, port_a);
 		if (conversation != NULL) {
 			/*
 			 * If this is for a connection-oriented protocol, set the
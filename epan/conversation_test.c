@@ -0,0 +1,121 @@
+/* conversation_test.c
+ * Standalone program to test the conversation hash tables
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <glib.h>
+
+#include <epan/epan.h>
+#include <epan/register.h>
+#include <epan/conversation.h>
+#include <wiretap/wtap.h>
+#include <wsutil/filesystem.h>
+#include <wsutil/privileges.h>
+
+/* Enough conversations to make each table grow several times. */
+#define CONVERSATION_TEST_FILL 2048
+
+static const guint8 addr_a_data[] = {10, 0, 0, 1};
+static const guint8 addr_b_data[] = {10, 0, 0, 2};
+
+/*
+ * Two conversations from B:1000 to A with a wildcarded port 2 share a key,
+ * so they are chained in the no_port2 table.  A packet from A:2000 to
+ * B:1000 at frame 1 matches the head of that chain, and find_conversation()
+ * sets its port 2, moving it to the exact table while the second
+ * conversation becomes the head of the no_port2 chain; both must still be
+ * found after the tables grow.
+ */
+static void
+conversation_test_set_port2_grow(void)
+{
+    address addr_a, addr_b;
+    conversation_t *first, *second, *conv;
+    guint32 port;
+
+    set_address(&addr_a, AT_IPv4, 4, addr_a_data);
+    set_address(&addr_b, AT_IPv4, 4, addr_b_data);
+
+    first = conversation_new(1, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 0, NO_PORT2);
+    second = conversation_new(2, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 0, NO_PORT2);
+    g_assert(first != second);
+
+    g_assert(find_conversation(1, &addr_a, &addr_b, ENDPOINT_TCP, 2000, 1000, 0) == first);
+    g_assert(!(first->options & NO_PORT2));
+
+    g_assert(find_conversation(1, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 2000, 0) == first);
+    g_assert(find_conversation(2, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 0, NO_PORT_B) == second);
+
+    for (port = 1; port <= CONVERSATION_TEST_FILL; port++) {
+        conversation_new(3, &addr_b, &addr_a, ENDPOINT_TCP, 10000 + port, 0, NO_PORT2);
+        conversation_new(3, &addr_b, &addr_a, ENDPOINT_TCP, 10000 + port, port, 0);
+    }
+
+    g_assert(find_conversation(1, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 2000, 0) == first);
+    g_assert(find_conversation(2, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 0, NO_PORT_B) == second);
+
+    /* The moved conversation must not be left behind in the no_port2 chain. */
+    g_assert(find_conversation(3, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 0, NO_PORT_B) == second);
+    g_assert(find_conversation(0, &addr_b, &addr_a, ENDPOINT_TCP, 1000, 0, NO_PORT_B) == NULL);
+
+    for (port = 1; port <= CONVERSATION_TEST_FILL; port++) {
+        conv = find_conversation(3, &addr_b, &addr_a, ENDPOINT_TCP, 10000 + port, 0, NO_PORT_B);
+        g_assert(conv != NULL);
+        g_assert(conv->options & NO_PORT2);
+        conv = find_conversation(3, &addr_b, &addr_a, ENDPOINT_TCP, 10000 + port, port, 0);
+        g_assert(conv != NULL);
+        g_assert(!(conv->options & NO_PORT2));
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    static const struct packet_provider_funcs funcs = { NULL, NULL, NULL, NULL, NULL };
+    char *init_progfile_dir_error;
+    epan_t *session;
+    int result;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/conversation/set_port2/grow", conversation_test_set_port2_grow);
+
+    init_process_policies();
+    init_progfile_dir_error = init_progfile_dir(argv[0], main);
+    g_free(init_progfile_dir_error);
+
+    wtap_init(FALSE);
+    if (!epan_init(register_all_protocols, register_all_protocol_handoffs, NULL, NULL))
+        return 2;
+
+    /* A session sets up the file scope the conversation tables live in. */
+    session = epan_new(NULL, &funcs);
+    result = g_test_run();
+    epan_free(session);
+
+    epan_cleanup();
+    wtap_cleanup();
+
+    return result;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
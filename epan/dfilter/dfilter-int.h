@@ -24,6 +24,8 @@ struct epan_dfilter {
 	GList		**registers;
 	gboolean	*attempted_load;
 	gboolean	*owns_memory;
+	gboolean	*borrowed;	/* register list belongs to shared_reads */
+	GHashTable	*shared_reads;	/* field values shared by a dfilter_set_t */
 	int		*interesting_fields;
 	int		num_interesting_fields;
 	GPtrArray	*deprecated;
@@ -150,6 +150,7 @@ dfilter_free(dfilter_t *df)
 	g_free(df->registers);
 	g_free(df->attempted_load);
 	g_free(df->owns_memory);
+	g_free(df->borrowed);
 	g_free(df);
 }
 
@@ -351,6 +352,7 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		dfilter->registers = g_new0(GList*, dfilter->max_registers);
 		dfilter->attempted_load = g_new0(gboolean, dfilter->max_registers);
 		dfilter->owns_memory = g_new0(gboolean, dfilter->max_registers);
+		dfilter->borrowed = g_new0(gboolean, dfilter->max_registers);
 
 		/* Initialize constants */
 		dfvm_init_const(dfilter);
@@ -409,6 +411,107 @@ dfilter_apply_edt(dfilter_t *df, epan_dissect_t* edt)
 	return dfvm_apply(df, edt->tree);
 }
 
+struct epan_dfilter_set {
+	GPtrArray	*filters;
+	GArray		*matched;	/* guint32 bitmask, one bit per filter */
+	GHashTable	*reads;		/* header_field_info * -> GList * of fvalues */
+};
+
+dfilter_set_t *
+dfilter_set_new(void)
+{
+	dfilter_set_t *dfs;
+
+	dfs = g_new(dfilter_set_t, 1);
+	dfs->filters = g_ptr_array_new();
+	dfs->matched = g_array_new(FALSE, TRUE, sizeof(guint32));
+	dfs->reads = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, (GDestroyNotify)g_list_free);
+	return dfs;
+}
+
+void
+dfilter_set_free(dfilter_set_t *dfs)
+{
+	if (!dfs)
+		return;
+
+	g_ptr_array_free(dfs->filters, TRUE);
+	g_array_free(dfs->matched, TRUE);
+	g_hash_table_destroy(dfs->reads);
+	g_free(dfs);
+}
+
+void
+dfilter_set_clear(dfilter_set_t *dfs)
+{
+	g_ptr_array_set_size(dfs->filters, 0);
+	g_array_set_size(dfs->matched, 0);
+}
+
+guint
+dfilter_set_add(dfilter_set_t *dfs, dfilter_t *df)
+{
+	g_ptr_array_add(dfs->filters, df);
+	g_array_set_size(dfs->matched, (dfs->filters->len + 31) / 32);
+	return dfs->filters->len - 1;
+}
+
+guint
+dfilter_set_count(const dfilter_set_t *dfs)
+{
+	return dfs->filters->len;
+}
+
+/* Apply one filter of the set, sharing field reads with the others. */
+static gboolean
+dfilter_set_apply_one(dfilter_set_t *dfs, dfilter_t *df, proto_tree *tree)
+{
+	gboolean passed;
+
+	df->shared_reads = dfs->reads;
+	passed = dfvm_apply(df, tree);
+	df->shared_reads = NULL;
+	return passed;
+}
+
+const guint32 *
+dfilter_set_apply_edt(dfilter_set_t *dfs, epan_dissect_t *edt)
+{
+	guint32	*matched = (guint32 *)(void *)dfs->matched->data;
+	guint	i;
+
+	memset(matched, 0, dfs->matched->len * sizeof(guint32));
+	for (i = 0; i < dfs->filters->len; i++) {
+		dfilter_t *df = (dfilter_t *)g_ptr_array_index(dfs->filters, i);
+
+		if (df && dfilter_set_apply_one(dfs, df, edt->tree)) {
+			matched[i / 32] |= 1U << (i % 32);
+		}
+	}
+	g_hash_table_remove_all(dfs->reads);
+
+	return matched;
+}
+
+int
+dfilter_set_apply_first_edt(dfilter_set_t *dfs, epan_dissect_t *edt)
+{
+	int	found = -1;
+	guint	i;
+
+	for (i = 0; i < dfs->filters->len; i++) {
+		dfilter_t *df = (dfilter_t *)g_ptr_array_index(dfs->filters, i);
+
+		if (df && dfilter_set_apply_one(dfs, df, edt->tree)) {
+			found = (int)i;
+			break;
+		}
+	}
+	g_hash_table_remove_all(dfs->reads);
+
+	return found;
+}
 
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree)
@@ -426,6 +529,13 @@ dfilter_has_interesting_fields(const dfilter_t *df)
 	return (df->num_interesting_fields > 0);
 }
 
+const int *
+dfilter_interesting_fields(const dfilter_t *df, int *num_fields)
+{
+	*num_fields = df->num_interesting_fields;
+	return df->interesting_fields;
+}
+
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df) {
 	if (df->deprecated && df->deprecated->len > 0) {
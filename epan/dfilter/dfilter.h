@@ -72,10 +72,60 @@ dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree);
 gboolean
 dfilter_has_interesting_fields(const dfilter_t *df);
 
+/* Get the ids of the fields/protocols used in a dfilter; the number of
+ * ids is returned in *num_fields. The array belongs to the dfilter. */
+WS_DLL_PUBLIC
+const int *
+dfilter_interesting_fields(const dfilter_t *df, int *num_fields);
+
 WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
 
+/* A set of compiled dfilters that are applied to the same protocol tree
+ * together; a field used by more than one of them is only read from the
+ * tree once.  The set doesn't own the dfilters. */
+typedef struct epan_dfilter_set dfilter_set_t;
+
+WS_DLL_PUBLIC
+dfilter_set_t *
+dfilter_set_new(void);
+
+WS_DLL_PUBLIC
+void
+dfilter_set_free(dfilter_set_t *dfs);
+
+/* Remove all dfilters from the set */
+WS_DLL_PUBLIC
+void
+dfilter_set_clear(dfilter_set_t *dfs);
+
+/* Add a dfilter to the set and return its index. A NULL dfilter
+ * never matches. */
+WS_DLL_PUBLIC
+guint
+dfilter_set_add(dfilter_set_t *dfs, dfilter_t *df);
+
+WS_DLL_PUBLIC
+guint
+dfilter_set_count(const dfilter_set_t *dfs);
+
+/* Apply all the dfilters in the set. Returns a bitmask with a bit set,
+ * as tested by DFILTER_SET_MATCHED(), for each dfilter that matched;
+ * it is valid until the set is next applied or changed. */
+WS_DLL_PUBLIC
+const guint32 *
+dfilter_set_apply_edt(dfilter_set_t *dfs, struct epan_dissect *edt);
+
+#define DFILTER_SET_MATCHED(mask, idx) \
+	(((mask)[(idx) / 32] >> ((idx) % 32)) & 1)
+
+/* Apply the dfilters in the set in order, stopping at the first one that
+ * matches. Returns its index, or -1 if none matched. */
+WS_DLL_PUBLIC
+int
+dfilter_set_apply_first_edt(dfilter_set_t *dfs, struct epan_dissect *edt);
+
 /* Print bytecode of dfilter to stdout */
 WS_DLL_PUBLIC
 void
@@ -8,6 +8,8 @@
 
 #include "config.h"
 
+#include <stdlib.h>
+
 #include "dfvm.h"
 
 #include <ftypes/ftypes-int.h>
@@ -36,6 +38,9 @@ dfvm_value_free(dfvm_value_t *v)
 		case DRANGE:
 			drange_free(v->value.drange);
 			break;
+		case UINT_SET:
+			g_array_free(v->value.uint_set, TRUE);
+			break;
 		default:
 			/* nothing */
 			;
@@ -85,6 +90,7 @@ dfvm_dump(FILE *f, dfilter_t *df)
 	char		*value_str;
 	GSList		*range_list;
 	drange_node	*range_item;
+	guint		i;
 
 	/* First dump the constant initializations */
 	fprintf(f, "Constants:\n");
@@ -119,6 +125,7 @@ dfvm_dump(FILE *f, dfilter_t *df)
 			case ANY_CONTAINS:
 			case ANY_MATCHES:
 			case ANY_IN_RANGE:
+			case ANY_IN_UINT_SET:
 			case NOT:
 			case RETURN:
 			case IF_TRUE_GOTO:
@@ -259,6 +266,16 @@ dfvm_dump(FILE *f, dfilter_t *df)
 					arg3->value.numeric);
 				break;
 
+			case ANY_IN_UINT_SET:
+				fprintf(f, "%05d ANY_IN_UINT_SET\treg#%u in {",
+					id, arg1->value.numeric);
+				for (i = 0; i < arg2->value.uint_set->len; i++) {
+					fprintf(f, "%s%u", i ? " " : "",
+						g_array_index(arg2->value.uint_set, guint32, i));
+				}
+				fprintf(f, "}\n");
+				break;
+
 			case NOT:
 				fprintf(f, "%05d NOT\n", id);
 				break;
@@ -289,6 +306,7 @@ dfvm_dump(FILE *f, dfilter_t *df)
 static gboolean
 read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 {
+	header_field_info *first_hfinfo = hfinfo;
 	GPtrArray	*finfos;
 	field_info	*finfo;
 	int		i, len;
@@ -307,6 +325,21 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 
 	df->attempted_load[reg] = TRUE;
 
+	/* Already read by another filter in the same dfilter_set_t? */
+	if (df->shared_reads) {
+		gpointer cached;
+
+		if (g_hash_table_lookup_extended(df->shared_reads, hfinfo, NULL, &cached)) {
+			if (cached == NULL) {
+				return FALSE;
+			}
+			df->registers[reg] = (GList *)cached;
+			df->owns_memory[reg] = FALSE;
+			df->borrowed[reg] = TRUE;
+			return TRUE;
+		}
+	}
+
 	while (hfinfo) {
 		finfos = proto_get_finfo_ptr_array(tree, hfinfo->id);
 		if ((finfos == NULL) || (g_ptr_array_len(finfos) == 0)) {
@@ -326,6 +359,13 @@ read_tree(dfilter_t *df, proto_tree *tree, header_field_info *hfinfo, int reg)
 		hfinfo = hfinfo->same_name_next;
 	}
 
+	if (df->shared_reads) {
+		/* Hand the list over to the set, which frees it once
+		 * all of its filters have been applied. */
+		g_hash_table_insert(df->shared_reads, first_hfinfo, fvalues);
+		df->borrowed[reg] = TRUE;
+	}
+
 	if (!found_something) {
 		return FALSE;
 	}
@@ -400,6 +440,24 @@ any_in_range(dfilter_t *df, int reg1, int reg2, int reg3)
 	return FALSE;
 }
 
+/* Tests whether any of the values in the register, which are 32-bit
+ * unsigned integers, is in the sorted set. */
+static gboolean
+any_in_uint_set(dfilter_t *df, int reg, GArray *set)
+{
+	GList	*list;
+	guint32	value;
+
+	for (list = df->registers[reg]; list; list = g_list_next(list)) {
+		value = fvalue_get_uinteger((fvalue_t *)list->data);
+		if (bsearch(&value, set->data, set->len, sizeof(guint32),
+					dfvm_compare_guint32)) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
 
 static void
 free_owned_register(gpointer data, gpointer user_data _U_)
@@ -422,9 +480,12 @@ free_register_overhead(dfilter_t* df)
 				g_list_foreach(df->registers[i], free_owned_register, NULL);
 				df->owns_memory[i] = FALSE;
 			}
-			g_list_free(df->registers[i]);
+			if (!df->borrowed[i]) {
+				g_list_free(df->registers[i]);
+			}
 			df->registers[i] = NULL;
 		}
+		df->borrowed[i] = FALSE;
 	}
 }
 
@@ -579,6 +640,11 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 						arg3->value.numeric);
 				break;
 
+			case ANY_IN_UINT_SET:
+				accum = any_in_uint_set(df, arg1->value.numeric,
+						arg2->value.uint_set);
+				break;
+
 			case NOT:
 				accum = !accum;
 				break;
@@ -654,6 +720,7 @@ dfvm_init_const(dfilter_t *df)
 			case ANY_CONTAINS:
 			case ANY_MATCHES:
 			case ANY_IN_RANGE:
+			case ANY_IN_UINT_SET:
 			case NOT:
 			case RETURN:
 			case IF_TRUE_GOTO:
@@ -23,7 +23,8 @@ typedef enum {
 	REGISTER,
 	INTEGER,
 	DRANGE,
-	FUNCTION_DEF
+	FUNCTION_DEF,
+	UINT_SET
 } dfvm_value_type_t;
 
 typedef struct {
@@ -35,6 +36,7 @@ typedef struct {
 		drange_t		*drange;
 		header_field_info	*hfinfo;
         df_func_def_t   *funcdef;
+		GArray			*uint_set;	/* sorted guint32 values */
 	} value;
 
 } dfvm_value_t;
@@ -60,10 +62,22 @@ typedef enum {
 	ANY_MATCHES,
 	MK_RANGE,
 	CALL_FUNCTION,
-	ANY_IN_RANGE
+	ANY_IN_RANGE,
+	ANY_IN_UINT_SET
 
 } dfvm_opcode_t;
 
+/* Order of the guint32 values in an ANY_IN_UINT_SET set; the code generator
+ * sorts with it and dfvm_apply() searches with it. */
+static inline gint
+dfvm_compare_guint32(gconstpointer a, gconstpointer b)
+{
+	guint32 ua = *(const guint32 *)a;
+	guint32 ub = *(const guint32 *)b;
+
+	return (ua > ub) - (ua < ub);
+}
+
 typedef struct {
 	int		id;
 	dfvm_opcode_t	op;
@@ -17,6 +17,7 @@
 #include "sttype-set.h"
 #include "sttype-function.h"
 #include "ftypes/ftypes.h"
+#include <ftypes/ftypes-int.h>
 
 static void
 gencode(dfwork_t *dfw, stnode_t *st_node);
@@ -287,6 +288,90 @@ fixup_jumps(gpointer data, gpointer user_data)
 	}
 }
 
+/* Returns TRUE if the membership test can be done with a single
+ * ANY_IN_UINT_SET instruction, i.e. if the LHS is a field whose values
+ * are all 32-bit unsigned integers and the set has at least two
+ * elements, none of them ranges. */
+static gboolean
+can_fold_uint_set(stnode_t *st_arg1, GSList *nodelist)
+{
+	header_field_info	*hfinfo;
+	stnode_t		*node1, *node2;
+	int			num_elements = 0;
+
+	if (stnode_type_id(st_arg1) != STTYPE_FIELD)
+		return FALSE;
+
+	hfinfo = (header_field_info*)stnode_data(st_arg1);
+	while (hfinfo->same_name_prev_id != -1) {
+		hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+	}
+	for (; hfinfo; hfinfo = hfinfo->same_name_next) {
+		if (!IS_FT_UINT32(hfinfo->type))
+			return FALSE;
+	}
+
+	while (nodelist) {
+		node1 = (stnode_t*)nodelist->data;
+		nodelist = g_slist_next(nodelist);
+		node2 = (stnode_t*)nodelist->data;
+		nodelist = g_slist_next(nodelist);
+
+		if (node2 || stnode_type_id(node1) != STTYPE_FVALUE)
+			return FALSE;
+		if (!IS_FT_UINT32(fvalue_type_ftenum((fvalue_t*)stnode_data(node1))))
+			return FALSE;
+		num_elements++;
+	}
+
+	return num_elements >= 2;
+}
+
+/* Generate the code for an in operator whose set can be folded into a
+ * sorted array of constants, searched with a single instruction rather
+ * than a chain of == tests. */
+static void
+gen_relation_in_uint_set(dfwork_t *dfw, stnode_t *st_arg1, GSList *nodelist)
+{
+	dfvm_insn_t	*insn;
+	dfvm_value_t	*val1, *val2;
+	dfvm_value_t	*jmp1 = NULL;
+	int		reg1;
+	GArray		*set;
+	stnode_t	*node1;
+	fvalue_t	*fv;
+
+	reg1 = gen_entity(dfw, st_arg1, &jmp1);
+
+	set = g_array_new(FALSE, FALSE, sizeof(guint32));
+	for (; nodelist; nodelist = g_slist_next(g_slist_next(nodelist))) {
+		guint32 value;
+
+		node1 = (stnode_t*)nodelist->data;
+		fv = (fvalue_t*)stnode_data(node1);
+		value = fvalue_get_uinteger(fv);
+		g_array_append_val(set, value);
+		/* Unlike the other constants, this one isn't handed to
+		 * a PUT_FVALUE instruction, so free it here. */
+		FVALUE_FREE(fv);
+	}
+	g_array_sort(set, dfvm_compare_guint32);
+
+	insn = dfvm_insn_new(ANY_IN_UINT_SET);
+	val1 = dfvm_value_new(REGISTER);
+	val1->value.numeric = reg1;
+	val2 = dfvm_value_new(UINT_SET);
+	val2->value.uint_set = set;
+	insn->arg1 = val1;
+	insn->arg2 = val2;
+	dfw_append_insn(dfw, insn);
+
+	/* Jump here if the LHS entity was not present */
+	if (jmp1) {
+		jmp1->value.numeric = dfw->next_insn_id;
+	}
+}
+
 /* Generate the code for the in operator.  It behaves much like an OR-ed
  * series of == tests, but without the redundant existence checks. */
 static void
@@ -300,6 +385,13 @@ gen_relation_in(dfwork_t *dfw, stnode_t *st_arg1, stnode_t *st_arg2)
 	GSList		*nodelist;
 	GSList		*jumplist = NULL;
 
+	nodelist = (GSList*)stnode_data(st_arg2);
+	if (can_fold_uint_set(st_arg1, nodelist)) {
+		gen_relation_in_uint_set(dfw, st_arg1, nodelist);
+		set_nodelist_free(nodelist);
+		return;
+	}
+
 	/* Create code for the LHS of the relation */
 	reg1 = gen_entity(dfw, st_arg1, &jmp1);
 
@@ -408,6 +500,58 @@ gen_entity(dfwork_t *dfw, stnode_t *st_arg, dfvm_value_t **p_jmp)
 	return reg;
 }
 
+/* Rough relative cost of evaluating an entity or a test; used to put
+ * the cheaper operand of "and" and "or" first, so that the expensive
+ * one (e.g. a regular expression match) is more often skipped. */
+static int
+entity_cost(stnode_t *st_arg)
+{
+	GSList	*params;
+	int	cost;
+
+	switch (stnode_type_id(st_arg)) {
+		case STTYPE_FIELD:
+			return 1;
+		case STTYPE_RANGE:
+			return 1 + entity_cost(sttype_range_entity(st_arg));
+		case STTYPE_FUNCTION:
+			cost = 4;
+			for (params = sttype_function_params(st_arg); params; params = params->next) {
+				cost += entity_cost((stnode_t *)params->data);
+			}
+			return cost;
+		default:
+			return 0;
+	}
+}
+
+static int
+test_cost(stnode_t *st_node)
+{
+	test_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+
+	sttype_test_get(st_node, &st_op, &st_arg1, &st_arg2);
+
+	switch (st_op) {
+		case TEST_OP_EXISTS:
+			return 1;
+		case TEST_OP_NOT:
+			return test_cost(st_arg1);
+		case TEST_OP_AND:
+		case TEST_OP_OR:
+			return test_cost(st_arg1) + test_cost(st_arg2);
+		case TEST_OP_CONTAINS:
+			return 4 + entity_cost(st_arg1) + entity_cost(st_arg2);
+		case TEST_OP_MATCHES:
+			return 16 + entity_cost(st_arg1) + entity_cost(st_arg2);
+		case TEST_OP_IN:
+			return 1 + entity_cost(st_arg1) +
+				(int)g_slist_length((GSList*)stnode_data(st_arg2)) / 2;
+		default:
+			return 1 + entity_cost(st_arg1) + entity_cost(st_arg2);
+	}
+}
 
 static void
 gen_test(dfwork_t *dfw, stnode_t *st_node)
@@ -456,6 +600,13 @@ gen_test(dfwork_t *dfw, stnode_t *st_node)
 			break;
 
 		case TEST_OP_AND:
+			/* Tests have no side effects, so the operands
+			 * can be evaluated in either order. */
+			if (test_cost(st_arg2) < test_cost(st_arg1)) {
+				stnode_t *tmp = st_arg1;
+				st_arg1 = st_arg2;
+				st_arg2 = tmp;
+			}
 			gencode(dfw, st_arg1);
 
 			insn = dfvm_insn_new(IF_FALSE_GOTO);
@@ -468,6 +619,11 @@ gen_test(dfwork_t *dfw, stnode_t *st_node)
 			break;
 
 		case TEST_OP_OR:
+			if (test_cost(st_arg2) < test_cost(st_arg1)) {
+				stnode_t *tmp = st_arg1;
+				st_arg1 = st_arg2;
+				st_arg2 = tmp;
+			}
 			gencode(dfw, st_arg1);
 
 			insn = dfvm_insn_new(IF_TRUE_GOTO);
@@ -456,9 +456,14 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 								  " the valid range is 0-1000000000",
 								  (long) pinfo->abs_ts.nsecs);
 			}
-			item = proto_tree_add_time(fh_tree, hf_frame_shift_offset, tvb,
-					    0, 0, &(pinfo->fd->shift_offset));
-			PROTO_ITEM_SET_GENERATED(item);
+			{
+				static const nstime_t no_shift_offset = { 0, 0 };
+				const nstime_t *shift_offset = epan_get_shift_offset(pinfo->epan, pinfo->fd);
+
+				item = proto_tree_add_time(fh_tree, hf_frame_shift_offset, tvb,
+						    0, 0, shift_offset ? shift_offset : &no_shift_offset);
+				PROTO_ITEM_SET_GENERATED(item);
+			}
 
 			if (generate_epoch_time) {
 				proto_tree_add_time(fh_tree, hf_frame_arrival_time_epoch, tvb,
@@ -60,6 +60,9 @@ static gboolean g_ip_dscp_actif = TRUE;
 /* Defragment fragmented IP datagrams */
 static gboolean ip_defragment = TRUE;
 
+/* Limit on the fragment data of incomplete reassemblies, in kilobytes (0 = none) */
+static guint ip_reassembly_memory_limit = 0;
+
 /* Place IP summary in proto tree */
 static gboolean ip_summary_in_tree = TRUE;
 
@@ -261,6 +264,7 @@ static expert_field ei_ip_ttl_lncb = EI_INIT;
 static expert_field ei_ip_ttl_too_small = EI_INIT;
 static expert_field ei_ip_cipso_tag = EI_INIT;
 static expert_field ei_ip_bogus_ip_version = EI_INIT;
+static expert_field ei_ip_reassembly_evicted = EI_INIT;
 
 static dissector_handle_t ip_handle;
 static dissector_table_t ip_option_table;
@@ -2233,6 +2237,10 @@ dissect_ip_v4(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
     next_tvb = process_reassembled_data(tvb, offset, pinfo, "Reassembled IPv4",
                                         ipfd_head, &ip_frag_items,
                                         &update_col_info, ip_tree);
+
+    if (ipfd_head == NULL && fragment_was_evicted(&ip_reassembly_table, pinfo)) {
+      proto_tree_add_expert(ip_tree, pinfo, &ei_ip_reassembly_evicted, tvb, 0, 0);
+    }
   } else {
     /* If this is the first fragment, dissect its contents, otherwise
        just show it as a fragment.
@@ -2420,6 +2428,13 @@ dissect_ip_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
     return TRUE;
 }
 
+static void
+ip_prefs_apply(void)
+{
+  reassembly_table_set_memory_limit(&ip_reassembly_table,
+                                    (gsize)ip_reassembly_memory_limit * 1024);
+}
+
 void
 proto_register_ip(void)
 {
@@ -2911,6 +2926,7 @@ proto_register_ip(void)
      { &ei_ip_ttl_too_small, { "ip.ttl.too_small", PI_SEQUENCE, PI_NOTE, "Time To Live", EXPFILL }},
      { &ei_ip_cipso_tag, { "ip.cipso.malformed", PI_SEQUENCE, PI_ERROR, "Malformed CIPSO tag", EXPFILL }},
      { &ei_ip_bogus_ip_version, { "ip.bogus_ip_version", PI_PROTOCOL, PI_ERROR, "Bogus IP version", EXPFILL }},
+     { &ei_ip_reassembly_evicted, { "ip.reassembly.evicted", PI_REASSEMBLE, PI_WARN, "Reassembly dropped, the reassembly memory limit was reached", EXPFILL }},
   };
 
   /* Decode As handling */
@@ -2937,7 +2953,7 @@ proto_register_ip(void)
   register_capture_dissector_table("ip.proto", "IP protocol");
 
   /* Register configuration options */
-  ip_module = prefs_register_protocol(proto_ip, NULL);
+  ip_module = prefs_register_protocol(proto_ip, ip_prefs_apply);
   prefs_register_bool_preference(ip_module, "decode_tos_as_diffserv",
     "Decode IPv4 TOS field as DiffServ field",
     "Whether the IPv4 type-of-service field should be decoded as a "
@@ -2945,6 +2961,11 @@ proto_register_ip(void)
   prefs_register_bool_preference(ip_module, "defragment",
     "Reassemble fragmented IPv4 datagrams",
     "Whether fragmented IPv4 datagrams should be reassembled", &ip_defragment);
+  prefs_register_uint_preference(ip_module, "reassembly_memory_limit",
+    "Reassembly memory limit (KB)",
+    "Maximum amount of fragment data, in kilobytes, kept for incomplete "
+    "reassemblies; the oldest ones are dropped when it is exceeded. "
+    "0 means no limit", 10, &ip_reassembly_memory_limit);
   prefs_register_bool_preference(ip_module, "summary_in_tree",
     "Show IPv4 summary in protocol tree",
     "Whether the IPv4 summary line should be shown in the protocol tree",
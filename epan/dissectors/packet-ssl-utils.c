@@ -4678,10 +4678,11 @@ ssl_add_record_info(gint proto, packet_info *pinfo, const guchar *data, gint dat
                          G_STRFUNC, rec->seq, rec->seq + data_len, (void*)flow);
     }
 
-    /* Remember decrypted records. */
-    prec = &pi->records;
-    while (*prec) prec = &(*prec)->next;
+    /* Remember decrypted records. A frame can hold many small records, so
+     * append at the tail rather than walking the list every time. */
+    prec = pi->records_tail ? &pi->records_tail->next : &pi->records;
     *prec = rec;
+    pi->records_tail = rec;
 }
 
 /* search in packet data for the specified id; return a newly created tvb for the associated data */
@@ -4695,14 +4696,24 @@ ssl_get_record_info(tvbuff_t *parent_tvb, int proto, packet_info *pinfo, gint re
     if (!pi)
         return NULL;
 
+    /* Records are normally looked up in the order they were added, so start
+     * right after the previous match and wrap around to the head if needed.
+     * This keeps redissecting a frame with many records linear. */
+    rec = pi->last_lookup ? pi->last_lookup->next : NULL;
+    for (; rec; rec = rec->next)
+        if (rec->id == record_id)
+            goto found;
     for (rec = pi->records; rec; rec = rec->next)
-        if (rec->id == record_id) {
-            *matched_record = rec;
-            /* link new real_data_tvb with a parent tvb so it is freed when frame dissection is complete */
-            return tvb_new_child_real_data(parent_tvb, rec->plain_data, rec->data_len, rec->data_len);
-        }
+        if (rec->id == record_id)
+            goto found;
 
     return NULL;
+
+found:
+    pi->last_lookup = rec;
+    *matched_record = rec;
+    /* link new real_data_tvb with a parent tvb so it is freed when frame dissection is complete */
+    return tvb_new_child_real_data(parent_tvb, rec->plain_data, rec->data_len, rec->data_len);
 }
 /* Links SSL records with the real packet data. }}} */
 
@@ -424,6 +424,8 @@ typedef struct _SslRecordInfo {
 
 typedef struct {
     SslRecordInfo *records; /**< Decrypted records within this frame. */
+    SslRecordInfo *records_tail;    /**< Last record, for appending. */
+    SslRecordInfo *last_lookup;     /**< Last record found by ssl_get_record_info(). */
     guint32 srcport;        /**< Used for Decode As */
     guint32 destport;
 } SslPacketInfo;
@@ -374,6 +374,15 @@ epan_get_user_comment(const epan_t *session, const frame_data *fd)
 	return NULL;
 }
 
+const nstime_t *
+epan_get_shift_offset(const epan_t *session, const frame_data *fd)
+{
+	if (session->funcs.get_shift_offset)
+		return session->funcs.get_shift_offset(session->prov, fd);
+
+	return NULL;
+}
+
 const char *
 epan_get_interface_name(const epan_t *session, guint32 interface_id)
 {
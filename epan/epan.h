@@ -44,6 +44,7 @@ struct packet_provider_funcs {
 	const char *(*get_interface_name)(struct packet_provider_data *prov, guint32 interface_id);
 	const char *(*get_interface_description)(struct packet_provider_data *prov, guint32 interface_id);
 	const char *(*get_user_comment)(struct packet_provider_data *prov, const frame_data *fd);
+	const nstime_t *(*get_shift_offset)(struct packet_provider_data *prov, const frame_data *fd);
 };
 
 #ifdef HAVE_PLUGINS
@@ -154,6 +155,8 @@ WS_DLL_PUBLIC const char *epan_get_interface_description(const epan_t *session,
 
 const nstime_t *epan_get_frame_ts(const epan_t *session, guint32 frame_num);
 
+const nstime_t *epan_get_shift_offset(const epan_t *session, const frame_data *fd);
+
 WS_DLL_PUBLIC void epan_free(epan_t *session);
 
 WS_DLL_PUBLIC const gchar*
@@ -72,12 +72,12 @@ typedef struct _frame_data {
     unsigned int has_phdr_comment : 1; /** 1 = there's comment for this packet */
     unsigned int has_user_comment : 1; /** 1 = user set (also deleted) comment for this packet */
     unsigned int need_colorize  : 1; /**< 1 = need to (re-)calculate packet color */
+    unsigned int has_shift_offset : 1; /**< 1 = abs_ts has been shifted by its own offset, see epan_get_shift_offset() */
   } flags;
 
   const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
 
   nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
   guint32      frame_ref_num; /**< Previous reference frame (0 if this is one) */
   guint32      prev_dis_num; /**< Previous displayed frame (0 if first one) */
 } frame_data;
@@ -76,22 +76,46 @@ in_cksum(const vec_t *vec, int veclen)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Force to a 4-byte boundary, so that the bulk of
+		 * the data can be summed 32 bits at a time.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
+		if ((2 & (gintptr)w) && (mlen >= 2)) {
+			sum += *w++;
+			mlen -= 2;
 		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
+		/*
+		 * Sum 32-bit words into a 64-bit accumulator.  Since
+		 * 2^16 is 1 modulo 2^16 - 1, folding that back down
+		 * to 16 bits gives the same one's complement sum as
+		 * adding up the 16-bit halves, whatever the byte order,
+		 * and the accumulator can't overflow the way a 32-bit
+		 * one can with more than 64KB of data.  Unroll the loop
+		 * to make overhead from branches &c small.
+		 */
+		if (mlen >= 4) {
+			const guint32 *d = (const guint32 *)(const void *)w;
+			guint64 sum64 = 0;
+
+			while ((mlen -= 32) >= 0) {
+				sum64 += d[0]; sum64 += d[1];
+				sum64 += d[2]; sum64 += d[3];
+				sum64 += d[4]; sum64 += d[5];
+				sum64 += d[6]; sum64 += d[7];
+				d += 8;
+			}
+			mlen += 32;
+			while ((mlen -= 4) >= 0) {
+				sum64 += *d++;
+			}
+			mlen += 4;
+			w = (const guint16 *)(const void *)d;
+
+			sum64 = (sum64 & 0xffffffff) + (sum64 >> 32);
+			sum64 = (sum64 & 0xffffffff) + (sum64 >> 32);
+			sum64 = (sum64 & 0xffff) + (sum64 >> 16);
+			sum64 = (sum64 & 0xffff) + (sum64 >> 16);
+			sum += (int)sum64;
 		}
-		mlen += 8;
 		if (mlen == 0 && byte_swapped == 0)
 			continue;
 		REDUCE;
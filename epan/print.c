@@ -1065,6 +1065,12 @@ proto_node_group_children_by_unique(proto_node *node) {
     return g_slist_reverse(unique_nodes_list);
 }
 
+/*
+ * Up to this many different json keys, groups are found by a linear search
+ * rather than by setting up a hash table for every node.
+ */
+#define JSON_KEY_LINEAR_SEARCH_MAX 8
+
 /**
  * Groups the children of a node by their json key. Children are put in the same group if they have the same json key.
  * @return Linked list where each element is another linked list of nodes associated with the same json key.
@@ -1074,41 +1080,61 @@ proto_node_group_children_by_json_key(proto_node *node)
 {
     /**
      * For each different json key we store a linked list of values corresponding to that json key. These lists are kept
-     * in both a linked list and a hashmap. The hashmap is used to quickly retrieve the values of a json key. The linked
-     * list is used to preserve the ordering of keys as they are encountered which is not guaranteed when only using a
-     * hashmap.
+     * in a linked list, which preserves the ordering of keys as they are encountered. Most nodes only have a few
+     * different keys, which are found by walking that list; once there are more, a hashmap from the json key to the
+     * element of that list is used to quickly retrieve the values of a json key.
      */
     GSList *same_key_nodes_list = NULL;
-    GHashTable *lookup_by_json_key = g_hash_table_new(g_str_hash, g_str_equal);
+    GHashTable *lookup_by_json_key = NULL;
+    guint same_key_nodes_count = 0;
     proto_node *current_child = node->first_child;
+    GSList *group;
 
     /**
-     * For each child of the node get the key and get the list of values already associated with that key from the
-     * hashmap. If no list exist yet for that key create a new one and add it to both the linked list and hashmap. If a
-     * list already exists add the node to that list.
+     * For each child of the node find the element holding the list of values already associated with its key. If no
+     * list exist yet for that key create a new one. Both lists are built by prepending, which is O(1), and reversed
+     * at the end.
      */
     while (current_child != NULL) {
-        char *json_key = (char *) proto_node_to_json_key(current_child);
-        GSList *json_key_nodes = (GSList *) g_hash_table_lookup(lookup_by_json_key, json_key);
-
-        if (json_key_nodes == NULL) {
-            json_key_nodes = g_slist_append(json_key_nodes, current_child);
-            // Prepending in single linked list is O(1), appending is O(n). Better to prepend here and reverse at the
-            // end than potentially looping to the end of the linked list for each child.
-            same_key_nodes_list = g_slist_prepend(same_key_nodes_list, json_key_nodes);
-            g_hash_table_insert(lookup_by_json_key, json_key, json_key_nodes);
+        const char *json_key = proto_node_to_json_key(current_child);
+
+        if (lookup_by_json_key != NULL) {
+            group = (GSList *) g_hash_table_lookup(lookup_by_json_key, json_key);
+        } else {
+            for (group = same_key_nodes_list; group != NULL; group = group->next) {
+                proto_node *group_node = (proto_node *) ((GSList *) group->data)->data;
+                if (strcmp(proto_node_to_json_key(group_node), json_key) == 0)
+                    break;
+            }
+        }
+
+        if (group == NULL) {
+            same_key_nodes_list = g_slist_prepend(same_key_nodes_list, g_slist_prepend(NULL, current_child));
+            same_key_nodes_count++;
+
+            if (lookup_by_json_key != NULL) {
+                g_hash_table_insert(lookup_by_json_key, (gpointer) json_key, same_key_nodes_list);
+            } else if (same_key_nodes_count > JSON_KEY_LINEAR_SEARCH_MAX) {
+                lookup_by_json_key = g_hash_table_new(g_str_hash, g_str_equal);
+                for (group = same_key_nodes_list; group != NULL; group = group->next) {
+                    proto_node *group_node = (proto_node *) ((GSList *) group->data)->data;
+                    g_hash_table_insert(lookup_by_json_key, (gpointer) proto_node_to_json_key(group_node), group);
+                }
+            }
         } else {
-            // Store and insert value again to circumvent unused_variable warning.
-            // Append in this case since most value lists will only have a single value.
-            json_key_nodes = g_slist_append(json_key_nodes, current_child);
-            g_hash_table_insert(lookup_by_json_key, json_key, json_key_nodes);
+            group->data = g_slist_prepend((GSList *) group->data, current_child);
         }
 
         current_child = current_child->next;
     }
 
-    // Hash table is not needed anymore since the linked list with the correct ordering is returned.
-    g_hash_table_destroy(lookup_by_json_key);
+    if (lookup_by_json_key != NULL) {
+        g_hash_table_destroy(lookup_by_json_key);
+    }
+
+    for (group = same_key_nodes_list; group != NULL; group = group->next) {
+        group->data = g_slist_reverse((GSList *) group->data);
+    }
 
     return g_slist_reverse(same_key_nodes_list);
 }
@@ -1810,53 +1836,64 @@ static void
 print_escaped_bare(FILE *fh, const char *unescaped_string, gboolean change_dot)
 {
     const char *p;
+    const char *run;
+    const char *escaped;
     char        temp_str[8];
 
     if (fh == NULL || unescaped_string == NULL) {
         return;
     }
 
+    /*
+     * Most strings need little or no escaping, so copy runs of
+     * characters that can be written as is with a single call instead
+     * of writing them one at a time.
+     */
+    run = unescaped_string;
     for (p = unescaped_string; *p != '\0'; p++) {
         switch (*p) {
         case '"':
-            fputs("\\\"", fh);
+            escaped = "\\\"";
             break;
         case '\\':
-            fputs("\\\\", fh);
+            escaped = "\\\\";
             break;
         case '/':
-            fputs("\\/", fh);
+            escaped = "\\/";
             break;
         case '\b':
-            fputs("\\b", fh);
+            escaped = "\\b";
             break;
         case '\f':
-            fputs("\\f", fh);
+            escaped = "\\f";
             break;
         case '\n':
-            fputs("\\n", fh);
+            escaped = "\\n";
             break;
         case '\r':
-            fputs("\\r", fh);
+            escaped = "\\r";
             break;
         case '\t':
-            fputs("\\t", fh);
+            escaped = "\\t";
             break;
         case '.':
-            if (change_dot)
-                fputs("_", fh);
-            else
-                fputs(".", fh);
+            if (!change_dot)
+                continue;
+            escaped = "_";
             break;
         default:
             if (g_ascii_isprint(*p))
-                fputc(*p, fh);
-            else {
-                g_snprintf(temp_str, sizeof(temp_str), "\\u00%02x", (guint8)*p);
-                fputs(temp_str, fh);
-            }
+                continue;
+            g_snprintf(temp_str, sizeof(temp_str), "\\u00%02x", (guint8)*p);
+            escaped = temp_str;
         }
+        if (p > run)
+            fwrite(run, 1, p - run, fh);
+        fputs(escaped, fh);
+        run = p + 1;
     }
+    if (p > run)
+        fwrite(run, 1, p - run, fh);
 }
 
 /* Print a string, escaping out certain characters that need to
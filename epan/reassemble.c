@@ -397,6 +397,117 @@ free_fragments(gpointer data, gpointer user_data _U_)
 	g_slice_free(fragment_item, fd_head);
 }
 
+/*
+ * Number of bytes of fragment data held by an incomplete reassembly.
+ */
+static gsize
+fragment_data_size(const fragment_head *fd_head)
+{
+	const fragment_item *fd;
+	gsize size = 0;
+
+	for (fd = fd_head->next; fd != NULL; fd = fd->next) {
+		if (fd->tvb_data)
+			size += fd->len;
+	}
+	return size;
+}
+
+typedef struct {
+	gpointer key;
+	fragment_head *fd_head;
+	gsize size;
+} evict_candidate_t;
+
+static gint
+evict_candidate_cmp(gconstpointer a, gconstpointer b)
+{
+	const evict_candidate_t *ca = (const evict_candidate_t *)a;
+	const evict_candidate_t *cb = (const evict_candidate_t *)b;
+
+	if (ca->fd_head->frame < cb->fd_head->frame)
+		return -1;
+	return ca->fd_head->frame > cb->fd_head->frame;
+}
+
+/*
+ * Work out how much fragment data the incomplete reassemblies in the
+ * table hold and, if that's over the table's limit, drop the ones that
+ * were least recently added to (fd_head->frame is the latest frame
+ * that added a fragment) until we're under 3/4 of the limit.  The
+ * frames of the dropped fragments are remembered so that dissectors
+ * can report them.
+ */
+static void
+reassembly_table_evict(reassembly_table *table, const packet_info *pinfo)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	GArray *candidates;
+	evict_candidate_t candidate, *victim;
+	fragment_item *fd;
+	gsize used = 0, target;
+	guint i;
+
+	candidates = g_array_new(FALSE, FALSE, sizeof(evict_candidate_t));
+
+	g_hash_table_iter_init(&iter, table->fragment_table);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		candidate.fd_head = (fragment_head *)value;
+		if (candidate.fd_head->flags & FD_DEFRAGMENTED)
+			continue;
+		candidate.size = fragment_data_size(candidate.fd_head);
+		if (candidate.size == 0)
+			continue;
+		used += candidate.size;
+		/* Don't pull reassemblies out from under the current frame */
+		if (candidate.fd_head->frame < pinfo->num) {
+			candidate.key = key;
+			g_array_append_val(candidates, candidate);
+		}
+	}
+
+	if (used > table->memory_limit) {
+		target = table->memory_limit - table->memory_limit / 4;
+		g_array_sort(candidates, evict_candidate_cmp);
+		for (i = 0; i < candidates->len && used > target; i++) {
+			victim = &g_array_index(candidates, evict_candidate_t, i);
+			for (fd = victim->fd_head->next; fd != NULL; fd = fd->next)
+				g_hash_table_add(table->evicted_table, GUINT_TO_POINTER(fd->frame));
+			/*
+			 * The key is freed by the table's key freeing
+			 * function, the fragments by free_all_fragments().
+			 */
+			g_hash_table_remove(table->fragment_table, victim->key);
+			free_all_fragments(NULL, victim->fd_head, NULL);
+			used -= victim->size;
+		}
+	}
+
+	g_array_free(candidates, TRUE);
+	table->memory_used = used;
+}
+
+/*
+ * Called on the first pass before a fragment of "frag_data_len" bytes is
+ * added to a table; if the table has a memory limit, and might now be
+ * over it, evict old incomplete reassemblies.
+ *
+ * This must be called before looking up any fragment_head in the table,
+ * as that might be the one that's evicted.
+ */
+static inline void
+reassembly_table_check_memory(reassembly_table *table,
+			      const packet_info *pinfo, const guint32 frag_data_len)
+{
+	if (table->memory_limit == 0)
+		return;
+
+	table->memory_used += frag_data_len;
+	if (table->memory_used > table->memory_limit)
+		reassembly_table_evict(table, pinfo);
+}
+
 typedef struct register_reassembly_table {
 	reassembly_table *table;
 	const reassembly_table_functions *funcs;
@@ -474,6 +585,13 @@ reassembly_table_init(reassembly_table *table,
 		table->reassembled_table = g_hash_table_new_full(reassembled_hash,
 		    reassembled_equal, reassembled_key_free, NULL);
 	}
+
+	if (table->evicted_table != NULL) {
+		g_hash_table_remove_all(table->evicted_table);
+	} else {
+		table->evicted_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+	}
+	table->memory_used = 0;
 }
 
 /*
@@ -530,6 +648,28 @@ reassembly_table_destroy(reassembly_table *table)
 		g_hash_table_destroy(table->reassembled_table);
 		table->reassembled_table = NULL;
 	}
+	if (table->evicted_table != NULL) {
+		g_hash_table_destroy(table->evicted_table);
+		table->evicted_table = NULL;
+	}
+	table->memory_used = 0;
+}
+
+/*
+ * Set the limit on the fragment data held by incomplete reassemblies.
+ */
+void
+reassembly_table_set_memory_limit(reassembly_table *table, const gsize max_bytes)
+{
+	table->memory_limit = max_bytes;
+}
+
+gboolean
+fragment_was_evicted(reassembly_table *table, const packet_info *pinfo)
+{
+	if (table->evicted_table == NULL)
+		return FALSE;
+	return g_hash_table_contains(table->evicted_table, GUINT_TO_POINTER(pinfo->num));
 }
 
 /*
@@ -1293,6 +1433,9 @@ fragment_add_common(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	 */
 	DISSECTOR_ASSERT(tvb_bytes_exist(tvb, offset, frag_data_len));
 
+	if (!pinfo->fd->flags.visited)
+		reassembly_table_check_memory(table, pinfo, frag_data_len);
+
 	fd_head = lookup_fd_head(table, pinfo, id, data, NULL);
 
 #if 0
@@ -1507,6 +1650,8 @@ fragment_add_check(reassembly_table *table, tvbuff_t *tvb, const int offset,
 		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
 	}
 
+	reassembly_table_check_memory(table, pinfo, frag_data_len);
+
 	/* Looks up a key in the GHashTable, returning the original key and the associated value
 	 * and a gboolean which is TRUE if the key was found. This is useful if you need to free
 	 * the memory allocated for the original key, for example before calling g_hash_table_remove()
@@ -1984,6 +2129,9 @@ fragment_add_seq(reassembly_table *table, tvbuff_t *tvb, const int offset,
 		 const guint32 frag_number, const guint32 frag_data_len,
 		 const gboolean more_frags, const guint32 flags)
 {
+	if (!pinfo->fd->flags.visited)
+		reassembly_table_check_memory(table, pinfo, frag_data_len);
+
 	return fragment_add_seq_common(table, tvb, offset, pinfo, id, data,
 				       frag_number, frag_data_len,
 				       more_frags, flags, NULL);
@@ -2045,6 +2193,8 @@ fragment_add_seq_check_work(reassembly_table *table, tvbuff_t *tvb,
 		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
 	}
 
+	reassembly_table_check_memory(table, pinfo, frag_data_len);
+
 	fd_head = fragment_add_seq_common(table, tvb, offset, pinfo, id, data,
 					  frag_number, frag_data_len,
 					  more_frags,
@@ -2191,6 +2341,7 @@ fragment_add_seq_single_work(reassembly_table *table, tvbuff_t *tvb,
 		fh = (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
 		return fh;
 	}
+	reassembly_table_check_memory(table, pinfo, frag_data_len);
 	/* First let's figure out where we want to add our new fragment */
 	fh = NULL;
 	if (first) {
@@ -130,6 +130,9 @@ typedef struct {
 	fragment_temporary_key temporary_key_func;
 	fragment_persistent_key persistent_key_func;
 	GDestroyNotify free_temporary_key_func;		/* temporary key destruction function */
+	gsize memory_limit;		/* bytes of incomplete reassemblies to keep, 0 for no limit */
+	gsize memory_used;		/* estimate of the bytes of incomplete reassemblies */
+	GHashTable *evicted_table;	/* frames with fragments of evicted reassemblies */
 } reassembly_table;
 
 /*
@@ -175,6 +178,20 @@ reassembly_table_init(reassembly_table *table,
 WS_DLL_PUBLIC void
 reassembly_table_destroy(reassembly_table *table);
 
+/*
+ * Limit the fragment data held by incomplete reassemblies in a table to
+ * approximately "max_bytes" (0, the default, means no limit).
+ *
+ * When the limit is exceeded during the first pass, the incomplete
+ * reassemblies that were least recently added to are dropped until the
+ * table is back under three quarters of the limit; fragments arriving
+ * for them afterwards start a new reassembly.  Only reassemblies that
+ * weren't touched in the current frame are dropped, but dissectors that
+ * hold on to fragment_head pointers across frames must not set a limit.
+ */
+WS_DLL_PUBLIC void
+reassembly_table_set_memory_limit(reassembly_table *table, const gsize max_bytes);
+
 /*
  * This function adds a new fragment to the reassembly table
  * If this is the first fragment seen for this datagram, a new entry
@@ -401,6 +418,15 @@ WS_DLL_PUBLIC fragment_head *
 fragment_get_reassembled_id(reassembly_table *table, const packet_info *pinfo,
 			    const guint32 id);
 
+/*
+ * Returns TRUE if a fragment in this frame belonged to a reassembly that
+ * was dropped because the table exceeded its memory limit.  As that
+ * happens in a later frame, this is only reliable once the frame has
+ * been visited.
+ */
+WS_DLL_PUBLIC gboolean
+fragment_was_evicted(reassembly_table *table, const packet_info *pinfo);
+
 /* This will free up all resources and delete reassembly state for this PDU.
  * Except if the PDU is completely reassembled, then it would NOT deallocate the
  * buffer holding the reassembled data but instead return the TVB
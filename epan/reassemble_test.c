@@ -1139,6 +1139,71 @@ test_fragment_add_seq_check_1(void)
     ASSERT(!tvb_memeql(fd_head->tvb_data,60,data+10,50));
 }
 
+/* Tests that incomplete reassemblies are evicted, oldest first, once the
+ * table's memory limit is exceeded.
+ */
+/*   visit  id  frame  frag  len  more  tvb_offset
+       0    12     1     0    50   T      10
+       0    13     2     0    40   T      10
+       0    14     3     0    40   T      10
+       0    15     4     0    30   T      10
+       0    12     5     1    20   F      10
+*/
+static void
+test_fragment_add_seq_check_memory_limit(void)
+{
+    fragment_head *fd_head;
+
+    printf("Starting test test_fragment_add_seq_check_memory_limit\n");
+
+    reassembly_table_set_memory_limit(&test_reassembly_table, 100);
+
+    pinfo.num = 1;
+    fd_head=fragment_add_seq_check(&test_reassembly_table, tvb, 10, &pinfo, 12, NULL,
+                                   0, 50, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    pinfo.num = 2;
+    fd_head=fragment_add_seq_check(&test_reassembly_table, tvb, 10, &pinfo, 13, NULL,
+                                   0, 40, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+
+    /* 130 bytes once this is added, but the limit is only checked before
+     * adding a fragment, and the table held 90 bytes at that point */
+    pinfo.num = 3;
+    fd_head=fragment_add_seq_check(&test_reassembly_table, tvb, 10, &pinfo, 14, NULL,
+                                   0, 40, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(3,g_hash_table_size(test_reassembly_table.fragment_table));
+
+    /* now the table is over the limit; datagrams 12 and 13 have to go to
+     * get it back under 75 bytes */
+    pinfo.num = 4;
+    fd_head=fragment_add_seq_check(&test_reassembly_table, tvb, 10, &pinfo, 15, NULL,
+                                   0, 30, TRUE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(2,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(0,g_hash_table_size(test_reassembly_table.reassembled_table));
+
+    /* the rest of datagram 12 can't complete the evicted reassembly */
+    pinfo.num = 5;
+    fd_head=fragment_add_seq_check(&test_reassembly_table, tvb, 10, &pinfo, 12, NULL,
+                                   1, 20, FALSE);
+    ASSERT_EQ_POINTER(NULL,fd_head);
+    ASSERT_EQ(3,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(0,g_hash_table_size(test_reassembly_table.reassembled_table));
+
+    pinfo.num = 1;
+    ASSERT(fragment_was_evicted(&test_reassembly_table, &pinfo));
+    pinfo.num = 2;
+    ASSERT(fragment_was_evicted(&test_reassembly_table, &pinfo));
+    pinfo.num = 3;
+    ASSERT(!fragment_was_evicted(&test_reassembly_table, &pinfo));
+    pinfo.num = 5;
+    ASSERT(!fragment_was_evicted(&test_reassembly_table, &pinfo));
+
+    reassembly_table_set_memory_limit(&test_reassembly_table, 0);
+}
+
 /**********************************************************************************
  *
  * fragment_add_seq_802_11
@@ -1532,6 +1597,7 @@ main(int argc _U_, char **argv _U_)
         test_fragment_add_seq_duplicate_conflict,
         test_fragment_add_seq_check,               /* frag + reassemble */
         test_fragment_add_seq_check_1,
+        test_fragment_add_seq_check_memory_limit,
         test_fragment_add_seq_802_11_0,
         test_fragment_add_seq_802_11_1,
         test_simple_fragment_add_seq_next,
@@ -87,6 +87,7 @@ typedef struct _tap_listener_t {
 	guint flags;
 	gchar *fstring;
 	dfilter_t *code;
+	int filter_index;	/* index of code in tap_filter_set, or -1 */
 	void *tapdata;
 	tap_reset_cb reset;
 	tap_packet_cb packet;
@@ -94,6 +95,9 @@ typedef struct _tap_listener_t {
 } tap_listener_t;
 static volatile tap_listener_t *tap_listener_queue=NULL;
 
+/* Filters of the listeners being run for the current packet */
+static dfilter_set_t *tap_filter_set=NULL;
+
 #ifdef HAVE_PLUGINS
 static GSList *tap_plugins = NULL;
 
@@ -288,6 +292,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 	tap_packet_t *tp;
 	volatile tap_listener_t *tl;
 	guint i;
+	const guint32 *passed_mask=NULL;
 
 	/* nothing to do, just return */
 	if(!tapping_is_active){
@@ -301,6 +306,32 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 		return;
 	}
 
+	/* Run the filters of all the listeners that will be handed a
+	   packet in one go, rather than once per queued packet, so that
+	   each filter is applied only once and fields used by several
+	   filters are only read from the tree once. */
+	if(!tap_filter_set){
+		tap_filter_set=dfilter_set_new();
+	}
+	dfilter_set_clear(tap_filter_set);
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		tl->filter_index=-1;
+		if(!tl->code){
+			continue;
+		}
+		for(i=0;i<tap_packet_index;i++){
+			tp=&tap_packet_array[i];
+			if(tp->tap_id==tl->tap_id &&
+			   (!(tp->flags & TAP_PACKET_IS_ERROR_PACKET) || (tl->flags & TL_REQUIRES_ERROR_PACKETS))){
+				tl->filter_index=dfilter_set_add(tap_filter_set, tl->code);
+				break;
+			}
+		}
+	}
+	if(dfilter_set_count(tap_filter_set)){
+		passed_mask=dfilter_set_apply_edt(tap_filter_set, edt);
+	}
+
 	/* loop over all tap listeners and call the listener callback
 	   for all packets that match the filter. */
 	for(i=0;i<tap_packet_index;i++){
@@ -311,7 +342,10 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 			{
 				if(tp->tap_id==tl->tap_id){
 					gboolean passed=TRUE;
-					if(tl->code){
+					if(tl->code && tl->filter_index>=0){
+						passed=DFILTER_SET_MATCHED(passed_mask, tl->filter_index);
+					} else if(tl->code){
+						/* listener added while pushing this packet */
 						passed=dfilter_apply_edt(tl->code, edt);
 					}
 					if(passed && tl->packet){
@@ -498,6 +532,7 @@ register_tap_listener(const char *tapname, void *tapdata, const char *fstring,
 	}
 	tl->fstring=g_strdup(fstring);
 	tl->code=code;
+	tl->filter_index=-1;
 
 	tl->tap_id=tap_id;
 	tl->tapdata=tapdata;
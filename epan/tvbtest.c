@@ -483,9 +483,138 @@ run_tests(void)
 	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
 }
 
+/* Compare the search functions with a naive search of random data.
+ * The data uses a small alphabet so there are lots of partial matches. */
+static void
+run_search_tests(void)
+{
+	GRand		*rand = g_rand_new_with_seed(42);
+	guint8		 data[512];
+	guint8		 needle[8];
+	tvbuff_t	*tvb, *needle_tvb;
+	guint		 len, needle_len, i, iter;
+	gint		 offset, maxlength, limit, expected, found, pos;
+	guint16		 needle16;
+
+	for (iter = 0; iter < 20000; iter++) {
+		len = g_rand_int_range(rand, 0, (gint) sizeof data);
+		for (i = 0; i < len; i++)
+			data[i] = (guint8) g_rand_int_range(rand, 0, 3);
+		tvb = tvb_new_real_data(data, len, len);
+
+		offset = g_rand_int_range(rand, 0, len + 1);
+		maxlength = g_rand_boolean(rand) ? -1 : g_rand_int_range(rand, 0, len + 1);
+		limit = len - offset;
+		if (maxlength >= 0 && maxlength < limit)
+			limit = maxlength;
+
+		needle16 = (guint16) (g_rand_int_range(rand, 0, 3) << 8 | g_rand_int_range(rand, 0, 3));
+		expected = -1;
+		for (pos = offset; pos + 1 < offset + limit; pos++) {
+			if (data[pos] == (needle16 >> 8) && data[pos + 1] == (needle16 & 0xFF)) {
+				expected = pos;
+				break;
+			}
+		}
+		found = tvb_find_guint16(tvb, offset, maxlength, needle16);
+		if (found != expected) {
+			printf("tvb_find_guint16 failed: length %u, offset %d, maxlength %d, needle 0x%04x: got %d, expected %d\n",
+			       len, offset, maxlength, needle16, found, expected);
+			failed = TRUE;
+		}
+
+		if (len > 0) {
+			needle_len = g_rand_int_range(rand, 1, (gint) sizeof needle + 1);
+			for (i = 0; i < needle_len; i++)
+				needle[i] = (guint8) g_rand_int_range(rand, 0, 3);
+			needle_tvb = tvb_new_real_data(needle, needle_len, needle_len);
+			expected = -1;
+			for (pos = offset; (guint) pos + needle_len <= len; pos++) {
+				if (memcmp(data + pos, needle, needle_len) == 0) {
+					expected = pos;
+					break;
+				}
+			}
+			found = tvb_find_tvb(tvb, needle_tvb, offset);
+			if (found != expected) {
+				printf("tvb_find_tvb failed: length %u, offset %d, needle length %u: got %d, expected %d\n",
+				       len, offset, needle_len, found, expected);
+				failed = TRUE;
+			}
+			tvb_free(needle_tvb);
+		}
+
+		tvb_free(tvb);
+	}
+
+	g_rand_free(rand);
+}
+
+#define PERF_DATA_LEN	(64 * 1024)
+#define PERF_ITERATIONS	2000
+
+static void
+report_perf(const char *name, gint64 start)
+{
+	double secs = (g_get_monotonic_time() - start) / 1000000.0;
+
+	printf("%-20s %8.1f MB/s\n", name,
+	       (double) PERF_DATA_LEN * PERF_ITERATIONS / (1024 * 1024) / secs);
+}
+
+/* Time the search functions on a large text buffer that looks like
+ * HTTP headers, searching for things that are only at the end. */
+static void
+run_search_perf(void)
+{
+	static const char line[] = "X-Header-Name: some/header value; with=parameters\r\n";
+	guint8		*data;
+	tvbuff_t	*tvb, *needle_tvb;
+	guint		 i;
+	gint		 offset, next_offset, found = 0;
+	gint64		 start;
+
+	data = (guint8 *) g_malloc(PERF_DATA_LEN);
+	for (i = 0; i < PERF_DATA_LEN; i++)
+		data[i] = line[i % (sizeof line - 1)];
+	memcpy(data + PERF_DATA_LEN - 4, "\r\n\r\n", 4);
+	tvb = tvb_new_real_data(data, PERF_DATA_LEN, PERF_DATA_LEN);
+	needle_tvb = tvb_new_real_data((const guint8 *) "\r\n\r\n", 4, 4);
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < PERF_ITERATIONS; i++)
+		found += tvb_find_tvb(tvb, needle_tvb, 0);
+	report_perf("tvb_find_tvb", start);
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < PERF_ITERATIONS; i++)
+		found += tvb_find_guint16(tvb, 0, -1, 0x0a0d);
+	report_perf("tvb_find_guint16", start);
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < PERF_ITERATIONS; i++)
+		found += tvb_strnlen(tvb, 0, -1);
+	report_perf("tvb_strnlen", start);
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < PERF_ITERATIONS; i++) {
+		for (offset = 0; offset < PERF_DATA_LEN; offset = next_offset)
+			found += tvb_find_line_end(tvb, offset, -1, &next_offset, FALSE);
+	}
+	report_perf("tvb_find_line_end", start);
+
+	/* Keep the compiler from optimizing the searches away */
+	if (found == 0)
+		printf("\n");
+
+	tvb_free(needle_tvb);
+	tvb_free(tvb);
+	g_free(data);
+}
+
 /* Note: valgrind can be used to check for tvbuff memory leaks */
 int
-main(void)
+main(int argc, char **argv)
 {
 	/* For valgrind: See GLib documentation: "Running GLib Applications" */
 	g_setenv("G_DEBUG", "gc-friendly", 1);
@@ -493,6 +622,10 @@ main(void)
 
 	except_init();
 	run_tests();
+	run_search_tests();
+	/* "tvbtest perf" also runs the search benchmarks */
+	if (argc > 1 && strcmp(argv[1], "perf") == 0)
+		run_search_perf();
 	except_deinit();
 	exit(failed?1:0);
 }
@@ -32,6 +32,7 @@
 #include "wsutil/unicode-utils.h"
 #include "wsutil/nstime.h"
 #include "wsutil/time_util.h"
+#include "wsutil/ws_memmem.h"
 #include "tvbuff.h"
 #include "tvbuff-int.h"
 #include "strutil.h"
@@ -2085,41 +2086,33 @@ gint
 tvb_find_guint16(tvbuff_t *tvb, const gint offset, const gint maxlength,
 		 const guint16 needle)
 {
-	const guint8 needle1 = ((needle & 0xFF00) >> 8);
-	const guint8 needle2 = ((needle & 0x00FF) >> 0);
-	gint searched_bytes = 0;
-	gint pos = offset;
-
-	do {
-		gint offset1 =
-			tvb_find_guint8(tvb, pos, maxlength - searched_bytes, needle1);
-		gint offset2 = -1;
-
-		if (offset1 == -1) {
-			return -1;
-		}
-
-		searched_bytes = offset - pos + 1;
+	const guint8  needle_bytes[2] = { (guint8)(needle >> 8), (guint8)(needle & 0xFF) };
+	const guint8 *ptr;
+	const guint8 *result;
+	guint	      abs_offset = 0;
+	guint	      limit = 0;
+	int           exception;
 
-		if ((maxlength != -1) && (searched_bytes >= maxlength)) {
-			return -1;
-		}
+	DISSECTOR_ASSERT(tvb && tvb->initialized);
 
-		offset2 = tvb_find_guint8(tvb, offset1 + 1, 1, needle2);
+	exception = compute_offset_and_remaining(tvb, offset, &abs_offset, &limit);
+	if (exception)
+		THROW(exception);
 
-		searched_bytes += 1;
+	/* Only search to end of tvbuff, w/o throwing exception. */
+	if (maxlength >= 0 && limit > (guint) maxlength) {
+		limit = (guint) maxlength;
+	}
 
-		if (offset2 != -1) {
-			if ((maxlength != -1) && (searched_bytes > maxlength)) {
-				return -1;
-			}
-			return offset1;
-		}
+	if (limit < 2)
+		return -1;
 
-		pos = offset1 + 1;
-	} while (searched_bytes < maxlength);
+	ptr = ensure_contiguous(tvb, abs_offset, limit);
+	result = ws_memmem(ptr, limit, needle_bytes, sizeof needle_bytes);
+	if (result == NULL)
+		return -1;
 
-	return -1;
+	return (gint) ((result - ptr) + abs_offset);
 }
 
 static inline gint
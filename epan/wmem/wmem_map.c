@@ -10,8 +10,12 @@
  */
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
+#include <wsutil/bits_ctz.h>
+
 #include "wmem_core.h"
 #include "wmem_list.h"
 #include "wmem_map.h"
@@ -41,6 +45,11 @@ typedef struct _wmem_map_item_t {
     struct _wmem_map_item_t *next;
 } wmem_map_item_t;
 
+typedef struct _wmem_map_slot_t {
+    const void *key;
+    void *value;
+} wmem_map_slot_t;
+
 struct _wmem_map_t {
     guint count; /* number of items stored */
 
@@ -52,6 +61,12 @@ struct _wmem_map_t {
 
     wmem_map_item_t **table;
 
+    /* Used instead of the table for WMEM_MAP_OPEN_ADDRESSING maps */
+    gboolean          open_addressing;
+    guint8           *ctrl;       /* one control byte per slot, see OA_CTRL_* */
+    wmem_map_slot_t  *slots;
+    guint             tombstones; /* number of OA_CTRL_DELETED slots */
+
     GHashFunc  hash_func;
     GEqualFunc eql_func;
 
@@ -76,6 +91,31 @@ struct _wmem_map_t {
 #define HASH(MAP, KEY) \
     ((guint32)(((MAP)->hash_func(KEY) * x) >> (32 - (MAP)->capacity)))
 
+/* Open addressing maps keep an array of control bytes next to the slots. The
+ * control byte of a full slot holds 7 bits of the key's hash (taken from
+ * different bits than the slot index), so probing compares the control bytes
+ * of a group of 8 slots at once and only calls eql_func for slots whose hash
+ * bits match. Groups are probed with increasing steps until a group with an
+ * empty slot is found; the table is resized before it gets more than 7/8
+ * full (including deleted slots), so there always is one.
+ *
+ * The control array has OA_GROUP_WIDTH - 1 extra bytes at the end mirroring
+ * the first ones, so that a group can be loaded starting at any slot. */
+#define OA_GROUP_WIDTH  8
+#define OA_CTRL_EMPTY   0x80
+#define OA_CTRL_DELETED 0xFE
+#define OA_CTRL_IS_FULL(C) (((C) & 0x80) == 0)
+
+#define OA_LSBS G_GUINT64_CONSTANT(0x0101010101010101)
+#define OA_MSBS G_GUINT64_CONSTANT(0x8080808080808080)
+
+#define OA_POS(MAP, HASHVAL) \
+    ((guint32)(((HASHVAL) * x) >> (32 - (MAP)->capacity)))
+#define OA_H2(HASHVAL) \
+    ((guint8)(((guint32)(HASHVAL) * 0x9E3779B1U) >> 25))
+
+#define OA_MAX_LOAD(MAP) (CAPACITY(MAP) - (CAPACITY(MAP) >> 3))
+
 static void
 wmem_map_init_table(wmem_map_t *map)
 {
@@ -87,6 +127,13 @@ wmem_map_init_table(wmem_map_t *map)
 wmem_map_t *
 wmem_map_new(wmem_allocator_t *allocator,
         GHashFunc hash_func, GEqualFunc eql_func)
+{
+    return wmem_map_new_flags(allocator, hash_func, eql_func, 0);
+}
+
+wmem_map_t *
+wmem_map_new_flags(wmem_allocator_t *allocator,
+        GHashFunc hash_func, GEqualFunc eql_func, guint flags)
 {
     wmem_map_t *map;
 
@@ -98,6 +145,10 @@ wmem_map_new(wmem_allocator_t *allocator,
     map->allocator = allocator;
     map->count = 0;
     map->table = NULL;
+    map->open_addressing = (flags & WMEM_MAP_OPEN_ADDRESSING) ? TRUE : FALSE;
+    map->ctrl = NULL;
+    map->slots = NULL;
+    map->tombstones = 0;
 
     return map;
 }
@@ -110,6 +161,9 @@ wmem_map_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
 
     map->count = 0;
     map->table = NULL;
+    map->ctrl  = NULL;
+    map->slots = NULL;
+    map->tombstones = 0;
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(map->master, map->master_cb_id);
@@ -144,6 +198,10 @@ wmem_map_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave,
     map->allocator = slave;
     map->count = 0;
     map->table = NULL;
+    map->open_addressing = FALSE;
+    map->ctrl = NULL;
+    map->slots = NULL;
+    map->tombstones = 0;
 
     map->master_cb_id = wmem_register_callback(master, wmem_map_destroy_cb, map);
     map->slave_cb_id  = wmem_register_callback(slave, wmem_map_reset_cb, map);
@@ -183,12 +241,232 @@ wmem_map_grow(wmem_map_t *map)
     wmem_free(map->allocator, old_table);
 }
 
+static inline guint64
+oa_group_load(const guint8 *ctrl)
+{
+    guint64 group;
+
+    memcpy(&group, ctrl, sizeof group);
+    return GUINT64_FROM_LE(group);
+}
+
+/* Sets the high bit of each byte of the group equal to h2. This can also
+ * flag a byte just above a real match (with value h2 ^ 1, so always a full
+ * slot); eql_func weeds those out. */
+static inline guint64
+oa_group_match(guint64 group, guint8 h2)
+{
+    guint64 cmp = group ^ (OA_LSBS * h2);
+
+    return (cmp - OA_LSBS) & ~cmp & OA_MSBS;
+}
+
+static inline guint64
+oa_group_match_empty(guint64 group)
+{
+    return group & (~group << 6) & OA_MSBS;
+}
+
+static inline guint64
+oa_group_match_empty_or_deleted(guint64 group)
+{
+    return group & ~(group << 7) & OA_MSBS;
+}
+
+#define OA_LOWEST_BYTE(MATCH) (ws_ctz(MATCH) >> 3)
+
+static inline void
+oa_set_ctrl(wmem_map_t *map, size_t i, guint8 c)
+{
+    map->ctrl[i] = c;
+    /* keep the mirrored copy of the first slots in sync */
+    map->ctrl[((i - (OA_GROUP_WIDTH - 1)) & (CAPACITY(map) - 1)) + (OA_GROUP_WIDTH - 1)] = c;
+}
+
+static void
+wmem_map_oa_alloc_table(wmem_map_t *map)
+{
+    map->ctrl  = (guint8 *)wmem_alloc(map->allocator, CAPACITY(map) + OA_GROUP_WIDTH - 1);
+    map->slots = wmem_alloc_array(map->allocator, wmem_map_slot_t, CAPACITY(map));
+    memset(map->ctrl, OA_CTRL_EMPTY, CAPACITY(map) + OA_GROUP_WIDTH - 1);
+    map->tombstones = 0;
+}
+
+static gboolean
+wmem_map_oa_find(wmem_map_t *map, const void *key, guint32 hash, size_t *index)
+{
+    size_t  mask = CAPACITY(map) - 1;
+    size_t  pos  = OA_POS(map, hash);
+    size_t  step = 0;
+    guint8  h2   = OA_H2(hash);
+    guint64 group, match;
+    size_t  i;
+
+    for (;;) {
+        group = oa_group_load(map->ctrl + pos);
+        for (match = oa_group_match(group, h2); match; match &= match - 1) {
+            i = (pos + OA_LOWEST_BYTE(match)) & mask;
+            if (map->eql_func(key, map->slots[i].key)) {
+                *index = i;
+                return TRUE;
+            }
+        }
+        if (oa_group_match_empty(group)) {
+            return FALSE;
+        }
+        step += OA_GROUP_WIDTH;
+        pos   = (pos + step) & mask;
+    }
+}
+
+static size_t
+wmem_map_oa_find_free(wmem_map_t *map, guint32 hash)
+{
+    size_t  mask = CAPACITY(map) - 1;
+    size_t  pos  = OA_POS(map, hash);
+    size_t  step = 0;
+    guint64 match;
+
+    for (;;) {
+        match = oa_group_match_empty_or_deleted(oa_group_load(map->ctrl + pos));
+        if (match) {
+            return (pos + OA_LOWEST_BYTE(match)) & mask;
+        }
+        step += OA_GROUP_WIDTH;
+        pos   = (pos + step) & mask;
+    }
+}
+
+/* Rebuilds the table with 2^capacity slots, which also drops any deleted
+ * slots. */
+static void
+wmem_map_oa_resize(wmem_map_t *map, size_t capacity)
+{
+    guint8          *old_ctrl;
+    wmem_map_slot_t *old_slots;
+    size_t           old_cap, i, j;
+    guint32          hash;
+
+    old_ctrl  = map->ctrl;
+    old_slots = map->slots;
+    old_cap   = CAPACITY(map);
+
+    map->capacity = capacity;
+    wmem_map_oa_alloc_table(map);
+
+    for (i = 0; i < old_cap; i++) {
+        if (OA_CTRL_IS_FULL(old_ctrl[i])) {
+            hash = map->hash_func(old_slots[i].key);
+            j    = wmem_map_oa_find_free(map, hash);
+            oa_set_ctrl(map, j, OA_H2(hash));
+            map->slots[j] = old_slots[i];
+        }
+    }
+
+    wmem_free(map->allocator, old_ctrl);
+    wmem_free(map->allocator, old_slots);
+}
+
+static void *
+wmem_map_oa_insert(wmem_map_t *map, const void *key, void *value)
+{
+    guint32 hash = map->hash_func(key);
+    size_t  i;
+    void   *old_val;
+
+    /* Make sure we have a table */
+    if (map->ctrl == NULL) {
+        map->count    = 0;
+        map->capacity = WMEM_MAP_DEFAULT_CAPACITY;
+        wmem_map_oa_alloc_table(map);
+    } else if (wmem_map_oa_find(map, key, hash, &i)) {
+        /* replace and return old value for this key */
+        old_val = map->slots[i].value;
+        map->slots[i].value = value;
+        return old_val;
+    }
+
+    /* make room if we are over-full; if that's only because of deleted
+     * slots, rebuilding at the same size is enough */
+    if (map->count + map->tombstones + 1 > OA_MAX_LOAD(map)) {
+        if (map->count + 1 > (CAPACITY(map) >> 1)) {
+            wmem_map_oa_resize(map, map->capacity + 1);
+        } else {
+            wmem_map_oa_resize(map, map->capacity);
+        }
+    }
+
+    /* insert new item */
+    i = wmem_map_oa_find_free(map, hash);
+    if (map->ctrl[i] == OA_CTRL_DELETED) {
+        map->tombstones--;
+    }
+    oa_set_ctrl(map, i, OA_H2(hash));
+    map->slots[i].key   = key;
+    map->slots[i].value = value;
+
+    map->count++;
+
+    /* no previous entry, return NULL */
+    return NULL;
+}
+
+static gboolean
+wmem_map_oa_lookup_extended(wmem_map_t *map, const void *key, const void **orig_key, void **value)
+{
+    size_t i;
+
+    /* Make sure we have a table */
+    if (map->ctrl == NULL) {
+        return FALSE;
+    }
+
+    if (!wmem_map_oa_find(map, key, map->hash_func(key), &i)) {
+        return FALSE;
+    }
+
+    if (orig_key) {
+        *orig_key = map->slots[i].key;
+    }
+    if (value) {
+        *value = map->slots[i].value;
+    }
+    return TRUE;
+}
+
+static gboolean
+wmem_map_oa_remove(wmem_map_t *map, const void *key, void **value)
+{
+    size_t i;
+
+    /* Make sure we have a table */
+    if (map->ctrl == NULL) {
+        return FALSE;
+    }
+
+    if (!wmem_map_oa_find(map, key, map->hash_func(key), &i)) {
+        return FALSE;
+    }
+
+    if (value) {
+        *value = map->slots[i].value;
+    }
+    oa_set_ctrl(map, i, OA_CTRL_DELETED);
+    map->tombstones++;
+    map->count--;
+    return TRUE;
+}
+
 void *
 wmem_map_insert(wmem_map_t *map, const void *key, void *value)
 {
     wmem_map_item_t **item;
     void *old_val;
 
+    if (map->open_addressing) {
+        return wmem_map_oa_insert(map, key, value);
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         wmem_map_init_table(map);
@@ -231,6 +509,10 @@ wmem_map_contains(wmem_map_t *map, const void *key)
 {
     wmem_map_item_t *item;
 
+    if (map->open_addressing) {
+        return wmem_map_oa_lookup_extended(map, key, NULL, NULL);
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         return FALSE;
@@ -254,6 +536,14 @@ void *
 wmem_map_lookup(wmem_map_t *map, const void *key)
 {
     wmem_map_item_t *item;
+    void *value;
+
+    if (map->open_addressing) {
+        if (wmem_map_oa_lookup_extended(map, key, NULL, &value)) {
+            return value;
+        }
+        return NULL;
+    }
 
     /* Make sure we have a table */
     if (map->table == NULL) {
@@ -279,6 +569,10 @@ wmem_map_lookup_extended(wmem_map_t *map, const void *key, const void **orig_key
 {
     wmem_map_item_t *item;
 
+    if (map->open_addressing) {
+        return wmem_map_oa_lookup_extended(map, key, orig_key, value);
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         return FALSE;
@@ -310,6 +604,13 @@ wmem_map_remove(wmem_map_t *map, const void *key)
     wmem_map_item_t **item, *tmp;
     void *value;
 
+    if (map->open_addressing) {
+        if (wmem_map_oa_remove(map, key, &value)) {
+            return value;
+        }
+        return NULL;
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         return NULL;
@@ -341,6 +642,10 @@ wmem_map_steal(wmem_map_t *map, const void *key)
 {
     wmem_map_item_t **item, *tmp;
 
+    if (map->open_addressing) {
+        return wmem_map_oa_remove(map, key, NULL);
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         return FALSE;
@@ -372,7 +677,15 @@ wmem_map_get_keys(wmem_allocator_t *list_allocator, wmem_map_t *map)
     wmem_map_item_t *cur;
     wmem_list_t* list = wmem_list_new(list_allocator);
 
-    if (map->table != NULL) {
+    if (map->ctrl != NULL) {
+        capacity = CAPACITY(map);
+
+        for (i=0; i<capacity; i++) {
+            if (OA_CTRL_IS_FULL(map->ctrl[i])) {
+                wmem_list_prepend(list, (void*)map->slots[i].key);
+            }
+        }
+    } else if (map->table != NULL) {
         capacity = CAPACITY(map);
 
         /* copy all the elements into the list over from table */
@@ -394,6 +707,15 @@ wmem_map_foreach(wmem_map_t *map, GHFunc foreach_func, gpointer user_data)
     wmem_map_item_t *cur;
     unsigned i;
 
+    if (map->ctrl != NULL) {
+        for (i = 0; i < CAPACITY(map); i++) {
+            if (OA_CTRL_IS_FULL(map->ctrl[i])) {
+                foreach_func((gpointer)map->slots[i].key, map->slots[i].value, user_data);
+            }
+        }
+        return;
+    }
+
     /* Make sure we have a table */
     if (map->table == NULL) {
         return;
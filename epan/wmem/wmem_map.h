@@ -58,6 +58,30 @@ wmem_map_new(wmem_allocator_t *allocator,
         GHashFunc hash_func, GEqualFunc eql_func)
 G_GNUC_MALLOC;
 
+/** Flag for wmem_map_new_flags(): store the items in an open addressing table
+ * instead of in per-bucket chains. Inserting does not allocate a node for
+ * each item, and lookups scan a small array of hash bits instead of following
+ * pointers, which makes it the better choice for maps that are looked up once
+ * or more per packet. Removing items leaves markers in the table that are
+ * only cleaned up when it is next resized, so it is less suited to maps with
+ * a lot of churn. */
+#define WMEM_MAP_OPEN_ADDRESSING 0x00000001
+
+/** Creates a map with the given allocator scope, like wmem_map_new(), using
+ * the storage selected by flags.
+ *
+ * @param allocator The allocator scope with which to create the map.
+ * @param hash_func The hash function used to place inserted keys.
+ * @param eql_func  The equality function used to compare inserted keys.
+ * @param flags     Zero, or WMEM_MAP_OPEN_ADDRESSING.
+ * @return The newly-allocated map.
+ */
+WS_DLL_PUBLIC
+wmem_map_t *
+wmem_map_new_flags(wmem_allocator_t *allocator,
+        GHashFunc hash_func, GEqualFunc eql_func, guint flags)
+G_GNUC_MALLOC;
+
 /** Creates a map with two allocator scopes. The base structure lives in the
  * master scope, however the data lives in the slave scope. Every time free_all
  * occurs in the slave scope the map is transparently emptied without affecting
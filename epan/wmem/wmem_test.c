@@ -977,6 +977,144 @@ wmem_test_map(void)
     wmem_destroy_allocator(allocator);
 }
 
+static void
+wmem_test_map_open_addressing(void)
+{
+    wmem_allocator_t   *allocator;
+    wmem_map_t       *map;
+    wmem_list_t      *keys;
+    gchar            *str_key;
+    const void       *key_ret;
+    unsigned int      i, j;
+    void             *ret;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    /* insertion, lookup and removal of simple integer keys */
+    map = wmem_map_new_flags(allocator, g_direct_hash, g_direct_equal,
+            WMEM_MAP_OPEN_ADDRESSING);
+    g_assert(map);
+    g_assert(wmem_map_lookup(map, GINT_TO_POINTER(1)) == NULL);
+    g_assert(wmem_map_remove(map, GINT_TO_POINTER(1)) == NULL);
+
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        ret = wmem_map_insert(map, GINT_TO_POINTER(i), GINT_TO_POINTER(777777));
+        g_assert(ret == NULL);
+        ret = wmem_map_insert(map, GINT_TO_POINTER(i), GINT_TO_POINTER(i));
+        g_assert(ret == GINT_TO_POINTER(777777));
+    }
+    g_assert(wmem_map_size(map) == CONTAINER_ITERS);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        ret = wmem_map_lookup(map, GINT_TO_POINTER(i));
+        g_assert(ret == GINT_TO_POINTER(i));
+        key_ret = NULL;
+        ret = NULL;
+        g_assert(wmem_map_lookup_extended(map, GINT_TO_POINTER(i), &key_ret, &ret));
+        g_assert(key_ret == GINT_TO_POINTER(i));
+        g_assert(ret == GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_map_contains(map, GINT_TO_POINTER(CONTAINER_ITERS)) == FALSE);
+
+    /* remove every other key, then check the rest can still be found
+     * past the deleted slots */
+    for (i=0; i<CONTAINER_ITERS; i+=2) {
+        ret = wmem_map_remove(map, GINT_TO_POINTER(i));
+        g_assert(ret == GINT_TO_POINTER(i));
+        ret = wmem_map_remove(map, GINT_TO_POINTER(i));
+        g_assert(ret == NULL);
+    }
+    g_assert(wmem_map_size(map) == CONTAINER_ITERS / 2);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        g_assert(wmem_map_contains(map, GINT_TO_POINTER(i)) == (i % 2 == 1));
+    }
+    g_assert(wmem_map_steal(map, GINT_TO_POINTER(1)) == TRUE);
+    g_assert(wmem_map_steal(map, GINT_TO_POINTER(1)) == FALSE);
+    g_assert(wmem_map_size(map) == CONTAINER_ITERS / 2 - 1);
+
+    /* keep inserting and removing so that deleted slots pile up and the
+     * table has to be rebuilt */
+    for (j=0; j<10; j++) {
+        for (i=CONTAINER_ITERS; i<2*CONTAINER_ITERS; i++) {
+            g_assert(wmem_map_insert(map, GINT_TO_POINTER(i), GINT_TO_POINTER(i)) == NULL);
+        }
+        for (i=CONTAINER_ITERS; i<2*CONTAINER_ITERS; i++) {
+            g_assert(wmem_map_remove(map, GINT_TO_POINTER(i)) == GINT_TO_POINTER(i));
+        }
+    }
+    g_assert(wmem_map_size(map) == CONTAINER_ITERS / 2 - 1);
+    for (i=3; i<CONTAINER_ITERS; i+=2) {
+        g_assert(wmem_map_lookup(map, GINT_TO_POINTER(i)) == GINT_TO_POINTER(i));
+    }
+
+    keys = wmem_map_get_keys(allocator, map);
+    g_assert(wmem_list_count(keys) == CONTAINER_ITERS / 2 - 1);
+    wmem_free_all(allocator);
+
+    /* string keys and for-each */
+    map = wmem_map_new_flags(allocator, wmem_str_hash, g_str_equal,
+            WMEM_MAP_OPEN_ADDRESSING);
+    g_assert(map);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        str_key = wmem_test_rand_string(allocator, 1, 64);
+        wmem_map_insert(map, str_key, GINT_TO_POINTER(2));
+        g_assert(wmem_map_lookup(map, str_key) == GINT_TO_POINTER(2));
+    }
+    wmem_map_foreach(map, check_val_map, GINT_TO_POINTER(2));
+
+    wmem_destroy_allocator(allocator);
+}
+
+/* NOTE: You have to run "wmem_test -m perf --verbose" to see results. */
+static void
+wmem_test_mapperf(void)
+{
+#define MAP_PERF_KEYS   (100 * 1000)
+#define MAP_PERF_ROUNDS 20
+    static const guint flags[] = { 0, WMEM_MAP_OPEN_ADDRESSING };
+    static const char *names[] = { "chained", "open addressing" };
+    wmem_allocator_t   *allocator;
+    wmem_map_t         *map;
+    guint32            *keys;
+    unsigned            f, i, r;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    keys = g_new(guint32, MAP_PERF_KEYS);
+    for (i = 0; i < MAP_PERF_KEYS; i++) {
+        keys[i] = g_test_rand_int();
+    }
+
+    for (f = 0; f < G_N_ELEMENTS(flags); f++) {
+        map = wmem_map_new_flags(allocator, g_int_hash, g_int_equal, flags[f]);
+
+        RESOURCE_USAGE_START;
+        for (i = 0; i < MAP_PERF_KEYS; i++) {
+            wmem_map_insert(map, &keys[i], GUINT_TO_POINTER(i + 1));
+        }
+        RESOURCE_USAGE_END;
+        g_test_minimized_result(utime_ms + stime_ms,
+            "wmem_map_insert (%s) %u keys: u %.3f ms s %.3f ms",
+            names[f], MAP_PERF_KEYS, utime_ms, stime_ms);
+
+        RESOURCE_USAGE_START;
+        for (r = 0; r < MAP_PERF_ROUNDS; r++) {
+            for (i = 0; i < MAP_PERF_KEYS; i++) {
+                g_assert(wmem_map_lookup(map, &keys[i]) != NULL);
+            }
+        }
+        RESOURCE_USAGE_END;
+        g_test_minimized_result(utime_ms + stime_ms,
+            "wmem_map_lookup (%s) %u hits: u %.3f ms s %.3f ms",
+            names[f], MAP_PERF_KEYS * MAP_PERF_ROUNDS, utime_ms, stime_ms);
+
+        wmem_free_all(allocator);
+    }
+
+    wmem_destroy_allocator(allocator);
+    g_free(keys);
+}
+
 static void
 wmem_test_queue(void)
 {
@@ -1292,6 +1430,179 @@ wmem_test_tree(void)
     wmem_destroy_allocator(allocator);
 }
 
+static gboolean
+wmem_test_tree_order_cb(const void *key, void *value _U_, void *user_data)
+{
+    guint32 *prev_key = (guint32 *)user_data;
+
+    g_assert(GPOINTER_TO_UINT(key) > *prev_key || *prev_key == G_MAXUINT32);
+    *prev_key = GPOINTER_TO_UINT(key);
+    return FALSE;
+}
+
+static gboolean
+wmem_test_tree_removed_cb(const void *key, void *value, void *user_data)
+{
+    guint32 *removed_key = (guint32 *)user_data;
+
+    g_assert(GPOINTER_TO_UINT(key) != *removed_key);
+    g_assert(value != NULL);
+    cb_called_count++;
+    return FALSE;
+}
+
+static void
+wmem_test_tree_bplus(void)
+{
+    wmem_allocator_t   *allocator, *extra_allocator;
+    wmem_tree_t        *tree, *rb_tree;
+    wmem_tree_key_t     keys[3];
+    guint32             key[2];
+    guint32             i, rand_int, prev_key;
+
+    allocator       = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+    extra_allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
+
+    /* test basic 32-bit key operations, in both insertion orders */
+    tree = wmem_tree_new_flags(allocator, WMEM_TREE_BPLUS);
+    g_assert(tree);
+    g_assert(wmem_tree_is_empty(tree));
+    g_assert(wmem_tree_lookup32_le(tree, 0) == NULL);
+    for (i=1; i<=CONTAINER_ITERS; i++) {
+        g_assert(wmem_tree_lookup32(tree, 2*i) == NULL);
+        g_assert(wmem_tree_lookup32_le(tree, 2*i) == GINT_TO_POINTER(i-1));
+        wmem_tree_insert32(tree, 2*i, GINT_TO_POINTER(i));
+        g_assert(wmem_tree_lookup32(tree, 2*i) == GINT_TO_POINTER(i));
+        g_assert(!wmem_tree_is_empty(tree));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS);
+    for (i=1; i<=CONTAINER_ITERS; i++) {
+        g_assert(wmem_tree_lookup32(tree, 2*i+1) == NULL);
+        g_assert(wmem_tree_lookup32_le(tree, 2*i+1) == GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_lookup32_le(tree, 1) == NULL);
+    g_assert(wmem_tree_remove32(tree, 2) == GINT_TO_POINTER(1));
+    g_assert(wmem_tree_lookup32(tree, 2) == NULL);
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS - 1);
+    prev_key = 2;
+    cb_called_count = 0;
+    wmem_tree_foreach(tree, wmem_test_tree_removed_cb, &prev_key);
+    g_assert(cb_called_count == CONTAINER_ITERS - 1);
+    wmem_free_all(allocator);
+
+    tree = wmem_tree_new_flags(allocator, WMEM_TREE_BPLUS);
+    for (i=CONTAINER_ITERS; i>0; i--) {
+        wmem_tree_insert32(tree, i, GINT_TO_POINTER(i));
+        g_assert(wmem_tree_lookup32(tree, i) == GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS);
+    wmem_free_all(allocator);
+
+    /* random keys must give the same answers as a red/black tree, and be
+     * iterated in order */
+    tree    = wmem_tree_new_flags(allocator, WMEM_TREE_BPLUS);
+    rb_tree = wmem_tree_new(allocator);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        rand_int = g_test_rand_int_range(0, 4*CONTAINER_ITERS);
+        wmem_tree_insert32(tree, rand_int, GINT_TO_POINTER(i));
+        wmem_tree_insert32(rb_tree, rand_int, GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_count(tree) == wmem_tree_count(rb_tree));
+    for (i=0; i<4*CONTAINER_ITERS; i++) {
+        g_assert(wmem_tree_lookup32(tree, i) == wmem_tree_lookup32(rb_tree, i));
+        g_assert(wmem_tree_lookup32_le(tree, i) == wmem_tree_lookup32_le(rb_tree, i));
+    }
+    prev_key = G_MAXUINT32;
+    wmem_tree_foreach(tree, wmem_test_tree_order_cb, &prev_key);
+    wmem_free_all(allocator);
+
+    /* test auto-reset functionality */
+    tree = wmem_tree_new_autoreset_flags(allocator, extra_allocator, WMEM_TREE_BPLUS);
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        wmem_tree_insert32(tree, i, GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS);
+    wmem_free_all(extra_allocator);
+    g_assert(wmem_tree_is_empty(tree));
+    g_assert(wmem_tree_lookup32(tree, 1) == NULL);
+    g_assert(wmem_tree_lookup32_le(tree, 1) == NULL);
+    wmem_free_all(allocator);
+
+    /* test array key functionality */
+    tree = wmem_tree_new_flags(allocator, WMEM_TREE_BPLUS);
+    keys[0].length = 1;
+    keys[0].key    = &key[0];
+    keys[1].length = 1;
+    keys[1].key    = &key[1];
+    keys[2].length = 0;
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key[0] = i % 7;
+        key[1] = 4 * i;
+        wmem_tree_insert32_array(tree, keys, GINT_TO_POINTER(i));
+    }
+    for (i=0; i<CONTAINER_ITERS; i++) {
+        key[0] = i % 7;
+        key[1] = 4 * i;
+        g_assert(wmem_tree_lookup32_array(tree, keys) == GINT_TO_POINTER(i));
+        key[1] += 1;
+        g_assert(wmem_tree_lookup32_array(tree, keys) == NULL);
+        g_assert(wmem_tree_lookup32_array_le(tree, keys) == GINT_TO_POINTER(i));
+    }
+    g_assert(wmem_tree_count(tree) == CONTAINER_ITERS);
+
+    wmem_destroy_allocator(extra_allocator);
+    wmem_destroy_allocator(allocator);
+}
+
+/* NOTE: You have to run "wmem_test -m perf --verbose" to see results. */
+static void
+wmem_test_treeperf(void)
+{
+#define TREE_PERF_KEYS (10 * 1000 * 1000)
+    static const guint32 flags[] = { 0, WMEM_TREE_BPLUS };
+    static const char *names[] = { "red/black", "B+" };
+    wmem_allocator_t   *allocator;
+    wmem_tree_t        *tree;
+    guint32            *keys;
+    unsigned            f, i;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    keys = g_new(guint32, TREE_PERF_KEYS);
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        keys[i] = g_test_rand_int();
+    }
+
+    for (f = 0; f < G_N_ELEMENTS(flags); f++) {
+        tree = wmem_tree_new_flags(allocator, flags[f]);
+
+        /* frame numbers are mostly inserted in order */
+        RESOURCE_USAGE_START;
+        for (i = 0; i < TREE_PERF_KEYS; i++) {
+            wmem_tree_insert32(tree, i, GUINT_TO_POINTER(i + 1));
+        }
+        RESOURCE_USAGE_END;
+        g_test_minimized_result(utime_ms + stime_ms,
+            "wmem_tree_insert32 (%s) %u keys: u %.3f ms s %.3f ms",
+            names[f], TREE_PERF_KEYS, utime_ms, stime_ms);
+
+        RESOURCE_USAGE_START;
+        for (i = 0; i < TREE_PERF_KEYS; i++) {
+            g_assert(wmem_tree_lookup32_le(tree, keys[i] % TREE_PERF_KEYS) != NULL);
+        }
+        RESOURCE_USAGE_END;
+        g_test_minimized_result(utime_ms + stime_ms,
+            "wmem_tree_lookup32_le (%s) %u random keys: u %.3f ms s %.3f ms",
+            names[f], TREE_PERF_KEYS, utime_ms, stime_ms);
+
+        wmem_free_all(allocator);
+    }
+
+    wmem_destroy_allocator(allocator);
+    g_free(keys);
+}
+
 
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
@@ -1420,12 +1731,19 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
     g_test_add_func("/wmem/datastruct/list",   wmem_test_list);
     g_test_add_func("/wmem/datastruct/map",    wmem_test_map);
+    g_test_add_func("/wmem/datastruct/map_open", wmem_test_map_open_addressing);
     g_test_add_func("/wmem/datastruct/queue",  wmem_test_queue);
     g_test_add_func("/wmem/datastruct/stack",  wmem_test_stack);
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
+    g_test_add_func("/wmem/datastruct/tree_bplus", wmem_test_tree_bplus);
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
 
+    if (g_test_perf()) {
+        g_test_add_func("/wmem/datastruct/mapperf", wmem_test_mapperf);
+        g_test_add_func("/wmem/datastruct/treeperf", wmem_test_treeperf);
+    }
+
     ret = g_test_run();
 
     wmem_cleanup();
@@ -44,6 +44,8 @@ typedef struct _wmem_tree_node_t wmem_tree_node_t;
 
 typedef struct _wmem_itree_node_t wmem_itree_node_t;
 
+typedef struct _wmem_btree_node_t wmem_btree_node_t;
+
 struct _wmem_tree_t {
     wmem_allocator_t *master;
     wmem_allocator_t *allocator;
@@ -51,6 +53,10 @@ struct _wmem_tree_t {
     guint             master_cb_id;
     guint             slave_cb_id;
 
+    /* Used instead of root for WMEM_TREE_BPLUS trees */
+    gboolean           bplus;
+    wmem_btree_node_t *broot;
+
     void (*post_rotation_cb)(wmem_tree_node_t *);
 };
 
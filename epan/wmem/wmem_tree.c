@@ -206,13 +206,25 @@ wmem_tree_new(wmem_allocator_t *allocator)
     return tree;
 }
 
+wmem_tree_t *
+wmem_tree_new_flags(wmem_allocator_t *allocator, guint32 flags)
+{
+    wmem_tree_t *tree;
+
+    tree = wmem_tree_new(allocator);
+    tree->bplus = (flags & WMEM_TREE_BPLUS) ? TRUE : FALSE;
+
+    return tree;
+}
+
 static gboolean
 wmem_tree_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
         void *user_data)
 {
     wmem_tree_t *tree = (wmem_tree_t *)user_data;
 
-    tree->root = NULL;
+    tree->root  = NULL;
+    tree->broot = NULL;
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(tree->master, tree->master_cb_id);
@@ -250,6 +262,127 @@ wmem_tree_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
     return tree;
 }
 
+wmem_tree_t *
+wmem_tree_new_autoreset_flags(wmem_allocator_t *master, wmem_allocator_t *slave,
+        guint32 flags)
+{
+    wmem_tree_t *tree;
+
+    tree = wmem_tree_new_autoreset(master, slave);
+    tree->bplus = (flags & WMEM_TREE_BPLUS) ? TRUE : FALSE;
+
+    return tree;
+}
+
+/* B+ trees (WMEM_TREE_BPLUS)
+ *
+ * All keys and values live in the leaves, which are chained in key order
+ * for iteration. An inner node with n children holds n - 1 separator keys,
+ * keys[i] being the smallest key in the subtree of child i + 1. Keys are
+ * never removed (wmem_tree_remove32 only clears the value), so the first
+ * key of every leaf but the leftmost one is the separator that leads to it,
+ * and the leaf that a search for a key ends up in always holds the largest
+ * key less than or equal to it, if there is one. */
+#define WMEM_BTREE_ORDER     32
+#define WMEM_BTREE_MAX_DEPTH 16 /* enough for 2^32 keys with half-full nodes */
+
+struct _wmem_btree_node_t {
+    guint              count;   /* number of keys (leaf) or children (inner) */
+    gboolean           is_leaf;
+    guint32            keys[WMEM_BTREE_ORDER];
+    void              *ptrs[WMEM_BTREE_ORDER]; /* values (leaf) or children */
+    guint8             is_subtree[WMEM_BTREE_ORDER]; /* leaf only */
+    wmem_btree_node_t *next;    /* next leaf */
+};
+
+static wmem_btree_node_t *
+btree_new_node(wmem_tree_t *tree, gboolean is_leaf)
+{
+    wmem_btree_node_t *node;
+
+    node = wmem_new(tree->allocator, wmem_btree_node_t);
+    node->count   = 0;
+    node->is_leaf = is_leaf;
+    node->next    = NULL;
+
+    return node;
+}
+
+/* Returns the index of the first of the n keys that is greater than key. */
+static inline guint
+btree_upper_bound(const guint32 *keys, guint n, guint32 key)
+{
+    guint low = 0, high = n, mid;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (keys[mid] <= key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static wmem_btree_node_t *
+btree_find_leaf(wmem_btree_node_t *node, guint32 key)
+{
+    while (!node->is_leaf) {
+        node = (wmem_btree_node_t *)node->ptrs[btree_upper_bound(node->keys, node->count - 1, key)];
+    }
+    return node;
+}
+
+static void *
+btree_lookup32(wmem_tree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *leaf;
+    guint              i;
+
+    if (!tree->broot) {
+        return NULL;
+    }
+
+    leaf = btree_find_leaf(tree->broot, key);
+    i    = btree_upper_bound(leaf->keys, leaf->count, key);
+    if (i > 0 && leaf->keys[i - 1] == key) {
+        return leaf->ptrs[i - 1];
+    }
+    return NULL;
+}
+
+static void *
+btree_lookup32_le(wmem_tree_t *tree, guint32 key)
+{
+    wmem_btree_node_t *leaf;
+    guint              i;
+
+    if (!tree->broot) {
+        return NULL;
+    }
+
+    leaf = btree_find_leaf(tree->broot, key);
+    i    = btree_upper_bound(leaf->keys, leaf->count, key);
+    return (i > 0) ? leaf->ptrs[i - 1] : NULL;
+}
+
+static void
+btree_leaf_insert_at(wmem_btree_node_t *leaf, guint pos, guint32 key,
+        void *value, gboolean is_subtree)
+{
+    guint n = leaf->count - pos;
+
+    memmove(leaf->keys + pos + 1, leaf->keys + pos, n * sizeof(guint32));
+    memmove(leaf->ptrs + pos + 1, leaf->ptrs + pos, n * sizeof(void *));
+    memmove(leaf->is_subtree + pos + 1, leaf->is_subtree + pos, n);
+
+    leaf->keys[pos]       = key;
+    leaf->ptrs[pos]       = value;
+    leaf->is_subtree[pos] = is_subtree ? 1 : 0;
+    leaf->count++;
+}
+
 static void
 free_tree_node(wmem_allocator_t *allocator, wmem_tree_node_t* node, gboolean free_keys, gboolean free_values)
 {
@@ -280,9 +413,31 @@ free_tree_node(wmem_allocator_t *allocator, wmem_tree_node_t* node, gboolean fre
     wmem_free(allocator, node);
 }
 
+static void
+free_btree_node(wmem_allocator_t *allocator, wmem_btree_node_t *node, gboolean free_keys, gboolean free_values)
+{
+    guint i;
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            free_btree_node(allocator, (wmem_btree_node_t *)node->ptrs[i], free_keys, free_values);
+        } else if (node->is_subtree[i]) {
+            wmem_tree_destroy((wmem_tree_t *)node->ptrs[i], free_keys, free_values);
+        } else if (free_values) {
+            wmem_free(allocator, node->ptrs[i]);
+        }
+    }
+
+    /* The keys are integers stored in the node, there's nothing to free */
+    wmem_free(allocator, node);
+}
+
 void
 wmem_tree_destroy(wmem_tree_t *tree, gboolean free_keys, gboolean free_values)
 {
+    if (tree->broot) {
+        free_btree_node(tree->allocator, tree->broot, free_keys, free_values);
+    }
     free_tree_node(tree->allocator, tree->root, free_keys, free_values);
     wmem_unregister_callback(tree->master, tree->master_cb_id);
     wmem_unregister_callback(tree->allocator, tree->slave_cb_id);
@@ -292,7 +447,7 @@ wmem_tree_destroy(wmem_tree_t *tree, gboolean free_keys, gboolean free_values)
 gboolean
 wmem_tree_is_empty(wmem_tree_t *tree)
 {
-    return tree->root == NULL;
+    return tree->root == NULL && tree->broot == NULL;
 }
 
 static gboolean
@@ -340,6 +495,151 @@ create_node(wmem_allocator_t *allocator, wmem_tree_node_t *parent, const void *k
 
 #define CREATE_DATA(TRANSFORM, DATA) ((TRANSFORM) ? (TRANSFORM)(DATA) : (DATA))
 
+static void *
+btree_lookup_or_insert32(wmem_tree_t *tree, guint32 key,
+        void*(*func)(void*), void* data, gboolean is_subtree, gboolean replace)
+{
+    wmem_btree_node_t *path[WMEM_BTREE_MAX_DEPTH];
+    guint              path_idx[WMEM_BTREE_MAX_DEPTH];
+    guint32            keys[WMEM_BTREE_ORDER];
+    void              *ptrs[WMEM_BTREE_ORDER + 1];
+    wmem_btree_node_t *node, *right;
+    guint              depth = 0, pos, half, n;
+    guint32            sep;
+    void              *value;
+
+    /* is this the first node ?*/
+    if (!tree->broot) {
+        node = btree_new_node(tree, TRUE);
+        value = CREATE_DATA(func, data);
+        btree_leaf_insert_at(node, 0, key, value, is_subtree);
+        tree->broot = node;
+        return value;
+    }
+
+    /* walk down to the leaf, remembering the way */
+    node = tree->broot;
+    while (!node->is_leaf) {
+        pos = btree_upper_bound(node->keys, node->count - 1, key);
+        g_assert(depth < WMEM_BTREE_MAX_DEPTH);
+        path[depth]     = node;
+        path_idx[depth] = pos;
+        depth++;
+        node = (wmem_btree_node_t *)node->ptrs[pos];
+    }
+
+    pos = btree_upper_bound(node->keys, node->count, key);
+    if (pos > 0 && node->keys[pos - 1] == key) {
+        /* this key already exists */
+        if (replace) {
+            node->ptrs[pos - 1]       = CREATE_DATA(func, data);
+            node->is_subtree[pos - 1] = is_subtree ? 1 : 0;
+        }
+        return node->ptrs[pos - 1];
+    }
+
+    value = CREATE_DATA(func, data);
+
+    if (node->count < WMEM_BTREE_ORDER) {
+        btree_leaf_insert_at(node, pos, key, value, is_subtree);
+        return value;
+    }
+
+    /* the leaf is full, split it in two */
+    half  = WMEM_BTREE_ORDER / 2;
+    right = btree_new_node(tree, TRUE);
+    right->count = WMEM_BTREE_ORDER - half;
+    memcpy(right->keys, node->keys + half, right->count * sizeof(guint32));
+    memcpy(right->ptrs, node->ptrs + half, right->count * sizeof(void *));
+    memcpy(right->is_subtree, node->is_subtree + half, right->count);
+    node->count = half;
+    right->next = node->next;
+    node->next  = right;
+
+    if (pos <= half) {
+        btree_leaf_insert_at(node, pos, key, value, is_subtree);
+    } else {
+        btree_leaf_insert_at(right, pos - half, key, value, is_subtree);
+    }
+    sep = right->keys[0];
+
+    /* add the new node to its parent, splitting that as well if needed */
+    while (depth > 0) {
+        depth--;
+        node = path[depth];
+        pos  = path_idx[depth];
+        n    = node->count;
+
+        if (n < WMEM_BTREE_ORDER) {
+            memmove(node->keys + pos + 1, node->keys + pos, (n - 1 - pos) * sizeof(guint32));
+            memmove(node->ptrs + pos + 2, node->ptrs + pos + 1, (n - 1 - pos) * sizeof(void *));
+            node->keys[pos]     = sep;
+            node->ptrs[pos + 1] = right;
+            node->count++;
+            return value;
+        }
+
+        /* lay out all WMEM_BTREE_ORDER + 1 children and their separators,
+         * then give the first half to node and the rest to a new one */
+        memcpy(keys, node->keys, pos * sizeof(guint32));
+        keys[pos] = sep;
+        memcpy(keys + pos + 1, node->keys + pos, (n - 1 - pos) * sizeof(guint32));
+        memcpy(ptrs, node->ptrs, (pos + 1) * sizeof(void *));
+        ptrs[pos + 1] = right;
+        memcpy(ptrs + pos + 2, node->ptrs + pos + 1, (n - 1 - pos) * sizeof(void *));
+
+        half  = (WMEM_BTREE_ORDER + 1) / 2;
+        right = btree_new_node(tree, FALSE);
+        memcpy(node->keys, keys, (half - 1) * sizeof(guint32));
+        memcpy(node->ptrs, ptrs, half * sizeof(void *));
+        node->count = half;
+        sep = keys[half - 1];
+        right->count = WMEM_BTREE_ORDER + 1 - half;
+        memcpy(right->keys, keys + half, (right->count - 1) * sizeof(guint32));
+        memcpy(right->ptrs, ptrs + half, right->count * sizeof(void *));
+    }
+
+    /* the root was split, grow a new one */
+    node = btree_new_node(tree, FALSE);
+    node->keys[0] = sep;
+    node->ptrs[0] = tree->broot;
+    node->ptrs[1] = right;
+    node->count   = 2;
+    tree->broot   = node;
+
+    return value;
+}
+
+static gboolean
+btree_foreach(wmem_tree_t *tree, wmem_foreach_func callback, void *user_data)
+{
+    wmem_btree_node_t *node = tree->broot;
+    guint              i;
+
+    if (!node) {
+        return FALSE;
+    }
+
+    while (!node->is_leaf) {
+        node = (wmem_btree_node_t *)node->ptrs[0];
+    }
+
+    for (; node; node = node->next) {
+        for (i = 0; i < node->count; i++) {
+            if (node->is_subtree[i]) {
+                if (wmem_tree_foreach((wmem_tree_t *)node->ptrs[i], callback, user_data)) {
+                    return TRUE;
+                }
+            } else if (node->ptrs[i] && /* No callback for "removed" entries */
+                    callback(GUINT_TO_POINTER(node->keys[i]), node->ptrs[i], user_data)) {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
 
 /**
  * return inserted node
@@ -407,7 +707,13 @@ static void *
 lookup_or_insert32(wmem_tree_t *tree, guint32 key,
         void*(*func)(void*), void* data, gboolean is_subtree, gboolean replace)
 {
-    wmem_tree_node_t *node = lookup_or_insert32_node(tree, key, func, data, is_subtree, replace);
+    wmem_tree_node_t *node;
+
+    if (tree->bplus) {
+        return btree_lookup_or_insert32(tree, key, func, data, is_subtree, replace);
+    }
+
+    node = lookup_or_insert32_node(tree, key, func, data, is_subtree, replace);
     return node->data;
 }
 
@@ -420,6 +726,9 @@ wmem_tree_lookup(wmem_tree_t *tree, const void *key, compare_func cmp)
         return NULL;
     }
 
+    /* B+ trees only support guint32 keys */
+    g_assert(!tree->bplus);
+
     node = tree->root;
 
     while (node) {
@@ -444,6 +753,9 @@ wmem_tree_insert(wmem_tree_t *tree, const void *key, void *data, compare_func cm
     wmem_tree_node_t *node = tree->root;
     wmem_tree_node_t *new_node = NULL;
 
+    /* B+ trees only support guint32 keys */
+    g_assert(!tree->bplus);
+
     /* is this the first node ?*/
     if (!node) {
         tree->root = create_node(tree->allocator, node, key,
@@ -501,6 +813,10 @@ wmem_tree_lookup32(wmem_tree_t *tree, guint32 key)
 {
     wmem_tree_node_t *node = tree->root;
 
+    if (tree->bplus) {
+        return btree_lookup32(tree, key);
+    }
+
     while (node) {
         if (key == GPOINTER_TO_UINT(node->key)) {
             return node->data;
@@ -521,6 +837,10 @@ wmem_tree_lookup32_le(wmem_tree_t *tree, guint32 key)
 {
     wmem_tree_node_t *node = tree->root;
 
+    if (tree->bplus) {
+        return btree_lookup32_le(tree, key);
+    }
+
     while (node) {
         if (key == GPOINTER_TO_UINT(node->key)) {
             return node->data;
@@ -634,7 +954,9 @@ wmem_tree_remove_string(wmem_tree_t* tree, const gchar* k, guint32 flags)
 static void *
 create_sub_tree(void* d)
 {
-    return wmem_tree_new(((wmem_tree_t *)d)->allocator);
+    wmem_tree_t *tree = (wmem_tree_t *)d;
+
+    return wmem_tree_new_flags(tree->allocator, tree->bplus ? WMEM_TREE_BPLUS : 0);
 }
 
 void
@@ -750,6 +1072,9 @@ gboolean
 wmem_tree_foreach(wmem_tree_t* tree, wmem_foreach_func callback,
         void *user_data)
 {
+    if (tree->bplus)
+        return btree_foreach(tree, callback, user_data);
+
     if(!tree->root)
         return FALSE;
 
@@ -801,6 +1126,39 @@ wmem_tree_print_nodes(const char *prefix, wmem_tree_node_t *node, guint32 level,
         wmem_print_subtree((wmem_tree_t *)node->data, level+1, key_printer, data_printer);
 }
 
+static void
+wmem_btree_print_nodes(wmem_btree_node_t *node, guint32 level,
+    wmem_printer_func key_printer, wmem_printer_func data_printer)
+{
+    guint i;
+
+    wmem_print_indent(level);
+    ws_debug_printf("%sNODE:%p count:%u\n", node->is_leaf ? "LEAF-" : "INNER-",
+            (void *)node, node->count);
+
+    for (i = 0; i < node->count; i++) {
+        if (!node->is_leaf) {
+            wmem_btree_print_nodes((wmem_btree_node_t *)node->ptrs[i], level+1, key_printer, data_printer);
+            continue;
+        }
+
+        wmem_print_indent(level+1);
+        ws_debug_printf("key:%u %s:%p\n", node->keys[i],
+                node->is_subtree[i]?"tree":"data", node->ptrs[i]);
+        if (key_printer) {
+            wmem_print_indent(level+1);
+            key_printer(GUINT_TO_POINTER(node->keys[i]));
+            ws_debug_printf("\n");
+        }
+        if (data_printer && !node->is_subtree[i]) {
+            wmem_print_indent(level+1);
+            data_printer(node->ptrs[i]);
+            ws_debug_printf("\n");
+        }
+        if (node->is_subtree[i])
+            wmem_print_subtree((wmem_tree_t *)node->ptrs[i], level+2, key_printer, data_printer);
+    }
+}
 
 static void
 wmem_print_subtree(wmem_tree_t *tree, guint32 level, wmem_printer_func key_printer, wmem_printer_func data_printer)
@@ -810,6 +1168,14 @@ wmem_print_subtree(wmem_tree_t *tree, guint32 level, wmem_printer_func key_print
 
     wmem_print_indent(level);
 
+    if (tree->bplus) {
+        ws_debug_printf("WMEM B+ tree:%p root:%p\n", (void *)tree, (void *)tree->broot);
+        if (tree->broot) {
+            wmem_btree_print_nodes(tree->broot, level, key_printer, data_printer);
+        }
+        return;
+    }
+
     ws_debug_printf("WMEM tree:%p root:%p\n", (void *)tree, (void *)tree->root);
     if (tree->root) {
         wmem_tree_print_nodes("Root-", tree->root, level, key_printer, data_printer);
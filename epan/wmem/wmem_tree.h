@@ -60,6 +60,29 @@ wmem_tree_t *
 wmem_tree_new_autoreset(wmem_allocator_t *master, wmem_allocator_t *slave)
 G_GNUC_MALLOC;
 
+/** Flag for wmem_tree_new_flags() and wmem_tree_new_autoreset_flags(): store
+ * the tree as a B+ tree with wide nodes instead of as a red/black tree. Lookups
+ * touch a handful of nodes rather than one per level, and inserts don't
+ * allocate a node for each key, which pays off for large trees keyed by frame
+ * number and the like. Only the guint32 key functions (including the _array
+ * ones) may be used with such a tree; string keys need a red/black tree. */
+#define WMEM_TREE_BPLUS                         0x00000001
+
+/** Creates a tree with the given allocator scope, like wmem_tree_new(), using
+ * the storage selected by flags (zero or WMEM_TREE_BPLUS). */
+WS_DLL_PUBLIC
+wmem_tree_t *
+wmem_tree_new_flags(wmem_allocator_t *allocator, guint32 flags)
+G_GNUC_MALLOC;
+
+/** Creates a tree with two allocator scopes, like wmem_tree_new_autoreset(),
+ * using the storage selected by flags (zero or WMEM_TREE_BPLUS). */
+WS_DLL_PUBLIC
+wmem_tree_t *
+wmem_tree_new_autoreset_flags(wmem_allocator_t *master, wmem_allocator_t *slave,
+        guint32 flags)
+G_GNUC_MALLOC;
+
 /** Cleanup memory used by tree.  Intended for NULL scope allocated trees */
 WS_DLL_PUBLIC
 void
@@ -242,7 +242,8 @@ ws_epan_new(capture_file *cf)
     ws_get_frame_ts,
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
-    cap_file_provider_get_user_comment
+    cap_file_provider_get_user_comment,
+    cap_file_provider_get_shift_offset
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -399,6 +400,12 @@ cf_close(capture_file *cf)
     g_tree_destroy(cf->provider.frames_user_comments);
     cf->provider.frames_user_comments = NULL;
   }
+  if (cf->provider.frames_shift_offsets) {
+    g_tree_destroy(cf->provider.frames_shift_offsets);
+    cf->provider.frames_shift_offsets = NULL;
+  }
+  nstime_set_zero(&cf->provider.shift_offset);
+  cf->provider.shift_offset_frames = 0;
   cf_unselect_packet(cf);   /* nothing to select */
   cf->first_displayed = 0;
   cf->last_displayed = 0;
@@ -88,3 +88,122 @@ cap_file_provider_set_user_comment(struct packet_provider_data *prov, frame_data
 
   fd->flags.has_user_comment = TRUE;
 }
+
+/*
+ * A time shift usually moves every frame by the same amount, so that offset
+ * is kept once, for frames 1 through shift_offset_frames. Only frames whose
+ * offset differs from it get an entry of their own in frames_shift_offsets,
+ * flagged with has_shift_offset.
+ */
+static const nstime_t no_shift_offset = { 0, 0 };
+
+static const nstime_t *
+shift_offset_default(struct packet_provider_data *prov, const frame_data *fd)
+{
+  return (fd->num <= prov->shift_offset_frames) ? &prov->shift_offset : &no_shift_offset;
+}
+
+const nstime_t *
+cap_file_provider_get_shift_offset(struct packet_provider_data *prov, const frame_data *fd)
+{
+  if (fd->flags.has_shift_offset && prov->frames_shift_offsets)
+    return (const nstime_t *)g_tree_lookup(prov->frames_shift_offsets, fd);
+
+  if (fd->num <= prov->shift_offset_frames)
+    return &prov->shift_offset;
+
+  return NULL;
+}
+
+/* Give the frame an offset of its own, even if it's the default one */
+static void
+set_frame_shift_offset(struct packet_provider_data *prov, frame_data *fd, const nstime_t *offset)
+{
+  nstime_t *frame_offset;
+
+  if (fd->flags.has_shift_offset && prov->frames_shift_offsets) {
+    frame_offset = (nstime_t *)g_tree_lookup(prov->frames_shift_offsets, fd);
+    nstime_copy(frame_offset, offset);
+    return;
+  }
+
+  if (!prov->frames_shift_offsets)
+    prov->frames_shift_offsets = g_tree_new_full(frame_cmp, NULL, NULL, g_free);
+
+  g_tree_insert(prov->frames_shift_offsets, fd, g_memdup(offset, sizeof *offset));
+
+  fd->flags.has_shift_offset = TRUE;
+}
+
+void
+cap_file_provider_set_shift_offset(struct packet_provider_data *prov, frame_data *fd, const nstime_t *offset)
+{
+  if (nstime_cmp(offset, shift_offset_default(prov, fd)) == 0) {
+    if (fd->flags.has_shift_offset && prov->frames_shift_offsets)
+      g_tree_remove(prov->frames_shift_offsets, fd);
+    fd->flags.has_shift_offset = FALSE;
+    return;
+  }
+
+  set_frame_shift_offset(prov, fd, offset);
+}
+
+static gboolean
+clear_shift_offset_flag(gpointer key, gpointer value _U_, gpointer data _U_)
+{
+  frame_data *fd = (frame_data *) key;
+
+  fd->flags.has_shift_offset = FALSE;
+  return FALSE;
+}
+
+void
+cap_file_provider_set_shift_offsets(struct packet_provider_data *prov, guint32 count, const nstime_t *offset)
+{
+  if (prov->frames_shift_offsets) {
+    g_tree_foreach(prov->frames_shift_offsets, clear_shift_offset_flag, NULL);
+    g_tree_destroy(prov->frames_shift_offsets);
+    prov->frames_shift_offsets = NULL;
+  }
+
+  nstime_copy(&prov->shift_offset, offset);
+  prov->shift_offset_frames = (nstime_cmp(offset, &no_shift_offset) == 0) ? 0 : count;
+}
+
+static gboolean
+add_shift_offset(gpointer key _U_, gpointer value, gpointer data)
+{
+  nstime_add((nstime_t *) value, (const nstime_t *) data);
+  return FALSE;
+}
+
+void
+cap_file_provider_add_shift_offsets(struct packet_provider_data *prov, guint32 count, const nstime_t *offset)
+{
+  guint32 i;
+  frame_data *fd;
+
+  /* Nothing moves, and frames past shift_offset_frames must stay unshifted */
+  if (nstime_cmp(offset, &no_shift_offset) == 0)
+    return;
+
+  if (prov->frames_shift_offsets)
+    g_tree_foreach(prov->frames_shift_offsets, add_shift_offset, (gpointer) offset);
+
+  /*
+   * Frames past shift_offset_frames weren't shifted yet, so they end
+   * up shifted by offset, while the common offset becomes
+   * shift_offset + offset; unless the common offset was zero, they
+   * need offsets of their own (which may be zero).
+   */
+  if (nstime_cmp(&prov->shift_offset, &no_shift_offset) != 0) {
+    for (i = prov->shift_offset_frames + 1; i <= count; i++) {
+      fd = frame_data_sequence_find(prov->frames, i);
+      if (fd && !fd->flags.has_shift_offset)
+        set_frame_shift_offset(prov, fd, offset);
+    }
+  }
+
+  nstime_add(&prov->shift_offset, offset);
+  prov->shift_offset_frames = count;
+}
@@ -61,6 +61,7 @@ typedef struct _ringbuf_data {
 
   int           fd;                  /* Current ringbuffer file descriptor */
   FILE         *pdh;
+  char         *pdh_buf;             /* stdio buffer for pdh, reused across file switches */
   gboolean      group_read_access;   /* TRUE if files need to be opened with group read access */
 } ringbuf_data;
 
@@ -219,7 +220,20 @@ ringbuf_init_libpcap_fdopen(int *err)
     if (err != NULL) {
       *err = errno;
     }
+    return NULL;
   }
+
+  /*
+   * Give the file a buffer large enough that records are written out
+   * in big chunks rather than one small write per block; dumpcap
+   * flushes it before telling its parent about new packets.  Only
+   * one file is open at a time, so the buffer is shared by all of
+   * them.
+   */
+  if (rb_data.pdh_buf == NULL)
+    rb_data.pdh_buf = (char *)g_malloc(RINGBUFFER_WRITE_BUFFER_SIZE);
+  setvbuf(rb_data.pdh, rb_data.pdh_buf, _IOFBF, RINGBUFFER_WRITE_BUFFER_SIZE);
+
   return rb_data.pdh;
 }
 
@@ -321,6 +335,11 @@ ringbuf_free(void)
     g_free(rb_data.fsuffix);
     rb_data.fsuffix = NULL;
   }
+  /* The buffer belongs to the open file, if there still is one */
+  if (rb_data.pdh == NULL && rb_data.pdh_buf != NULL) {
+    g_free(rb_data.pdh_buf);
+    rb_data.pdh_buf = NULL;
+  }
 }
 
 /*
@@ -22,6 +22,8 @@
 #define RINGBUFFER_MAX_NUM_FILES 100000
 /* Maximum number for FAT filesystems */
 #define RINGBUFFER_WARN_NUM_FILES 65535
+/* Size of the stdio buffer used when writing a ringbuffer file */
+#define RINGBUFFER_WRITE_BUFFER_SIZE (1024 * 1024)
 
 int ringbuf_init(const char *capture_name, guint num_files, gboolean group_read_access);
 const gchar *ringbuf_current_filename(void);
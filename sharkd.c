@@ -233,7 +233,8 @@ sharkd_epan_new(capture_file *cf)
     sharkd_get_frame_ts,
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
-    cap_file_provider_get_user_comment
+    cap_file_provider_get_user_comment,
+    NULL
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -690,6 +691,76 @@ sharkd_retap(void)
   return 0;
 }
 
+/*
+ * Fields which the frame dissector takes straight from frame_data.
+ * A filter that uses only these can be evaluated without reading and
+ * dissecting the frames again.
+ */
+enum {
+  SHARKD_FD_FIELD_NUMBER,
+  SHARKD_FD_FIELD_LEN,
+  SHARKD_FD_FIELD_CAP_LEN,
+  SHARKD_FD_FIELD_TIME,
+  SHARKD_FD_FIELD_MARKED,
+  SHARKD_FD_FIELD_IGNORED,
+  SHARKD_FD_FIELD_COUNT
+};
+
+static const char *const sharkd_fd_field_names[SHARKD_FD_FIELD_COUNT] = {
+  "frame.number",
+  "frame.len",
+  "frame.cap_len",
+  "frame.time",
+  "frame.marked",
+  "frame.ignored"
+};
+
+static gboolean
+sharkd_filter_is_frame_data_only(const dfilter_t *dfcode, int *hf_ids)
+{
+  const int *fields;
+  int num_fields;
+  int i, j;
+
+  for (j = 0; j < SHARKD_FD_FIELD_COUNT; j++) {
+    hf_ids[j] = proto_registrar_get_id_byname(sharkd_fd_field_names[j]);
+    if (hf_ids[j] == -1)
+      return FALSE;
+  }
+
+  fields = dfilter_interesting_fields(dfcode, &num_fields);
+  for (i = 0; i < num_fields; i++) {
+    for (j = 0; j < SHARKD_FD_FIELD_COUNT; j++) {
+      if (fields[i] == hf_ids[j])
+        break;
+    }
+    if (j == SHARKD_FD_FIELD_COUNT)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/*
+ * Add the frame_data fields used by the filter, with the same values
+ * the frame dissector would have given them.
+ */
+static void
+sharkd_filter_add_frame_data(proto_tree *tree, const int *hf_ids, const frame_data *fdata)
+{
+  if (proto_field_is_referenced(tree, hf_ids[SHARKD_FD_FIELD_NUMBER]))
+    proto_tree_add_uint(tree, hf_ids[SHARKD_FD_FIELD_NUMBER], NULL, 0, 0, fdata->num);
+  if (proto_field_is_referenced(tree, hf_ids[SHARKD_FD_FIELD_LEN]))
+    proto_tree_add_uint(tree, hf_ids[SHARKD_FD_FIELD_LEN], NULL, 0, 0, fdata->pkt_len);
+  if (proto_field_is_referenced(tree, hf_ids[SHARKD_FD_FIELD_CAP_LEN]))
+    proto_tree_add_uint(tree, hf_ids[SHARKD_FD_FIELD_CAP_LEN], NULL, 0, 0, fdata->cap_len);
+  if (fdata->flags.has_ts && proto_field_is_referenced(tree, hf_ids[SHARKD_FD_FIELD_TIME]))
+    proto_tree_add_time(tree, hf_ids[SHARKD_FD_FIELD_TIME], NULL, 0, 0, &fdata->abs_ts);
+  if (proto_field_is_referenced(tree, hf_ids[SHARKD_FD_FIELD_MARKED]))
+    proto_tree_add_boolean(tree, hf_ids[SHARKD_FD_FIELD_MARKED], NULL, 0, 0, fdata->flags.marked);
+  if (proto_field_is_referenced(tree, hf_ids[SHARKD_FD_FIELD_IGNORED]))
+    proto_tree_add_boolean(tree, hf_ids[SHARKD_FD_FIELD_IGNORED], NULL, 0, 0, fdata->flags.ignored);
+}
+
 int
 sharkd_filter(const char *dftext, guint8 **result)
 {
@@ -707,11 +778,16 @@ sharkd_filter(const char *dftext, guint8 **result)
 
   epan_dissect_t edt;
 
+  int fd_hf_ids[SHARKD_FD_FIELD_COUNT];
+  gboolean frame_data_only;
+
   if (!dfilter_compile(dftext, &dfcode, &err_info)) {
     g_free(err_info);
     return -1;
   }
 
+  frame_data_only = (dfcode != NULL && sharkd_filter_is_frame_data_only(dfcode, fd_hf_ids));
+
   frames_count = cfile.count;
 
   wtap_rec_init(&rec);
@@ -729,6 +805,17 @@ sharkd_filter(const char *dftext, guint8 **result)
       passed_bits = 0;
     }
 
+    if (frame_data_only) {
+      epan_dissect_prime_with_dfilter(&edt, dfcode);
+      sharkd_filter_add_frame_data(edt.tree, fd_hf_ids, fdata);
+
+      if (dfilter_apply_edt(dfcode, &edt))
+        passed_bits |= (1 << (framenum % 8));
+
+      epan_dissect_reset(&edt);
+      continue;
+    }
+
     if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
       break;
 
@@ -4003,6 +4003,23 @@ sharkd_session_main(void)
 
 	filter_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, sharkd_session_filter_free);
 
+	/*
+	 * Requests are processed strictly one at a time, in the order they
+	 * were received:
+	 *
+	 *  - responses carry no request identifier, so clients match them
+	 *    to requests by order, and
+	 *
+	 *  - even "read-only" requests such as "frames" and "frame" dissect
+	 *    packets, which updates state shared by the whole epan library
+	 *    (conversations, reassembly tables, the file wmem scope, ...),
+	 *    and that isn't safe to do from more than one thread, even with
+	 *    an epan_t per thread.
+	 *
+	 * Clients that want a slow "tap" or "intervals" request not to hold
+	 * up other requests should open another session; each session is
+	 * handled by its own process (see sharkd_loop()).
+	 */
 	while (fgets(buf, sizeof(buf), stdin))
 	{
 		/* every command is line seperated JSON */
@@ -56,12 +56,24 @@ check_dut() {
 	fi
 }
 
+unittests_step_conversation_test() {
+	check_dut conversation_test || return
+	ARGS=
+	unittests_step_test
+}
+
 unittests_step_exntest() {
 	check_dut exntest || return
 	ARGS=
 	unittests_step_test
 }
 
+unittests_step_file_wrappers_test() {
+	check_dut file_wrappers_test || return
+	ARGS=
+	unittests_step_test
+}
+
 unittests_step_oids_test() {
 	check_dut oids_test || return
 	ARGS=
@@ -105,7 +117,9 @@ unittests_cleanup_step() {
 unittests_suite() {
 	test_step_set_pre unittests_cleanup_step
 	test_step_set_post unittests_cleanup_step
+	test_step_add "conversation_test" unittests_step_conversation_test
 	test_step_add "exntest" unittests_step_exntest
+	test_step_add "file_wrappers_test" unittests_step_file_wrappers_test
 	test_step_add "oids_test" unittests_step_oids_test
 	test_step_add "reassemble_test" unittests_step_reassemble_test
 	test_step_add "tvbtest" unittests_step_tvbtest
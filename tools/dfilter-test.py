@@ -18,6 +18,7 @@ from dftestlib.bytes_type import testBytes
 from dftestlib.bytes_ether import testBytesEther
 from dftestlib.bytes_ipv6 import testBytesIPv6
 from dftestlib.double import testDouble
+from dftestlib.filter_set import testFilterSet
 from dftestlib.integer import testInteger
 from dftestlib.integer_1byte import testInteger1Byte
 from dftestlib.ipv4 import testIPv4
@@ -77,3 +77,36 @@ class DFTest(unittest.TestCase):
 
         # tshark must succeed
         self.assertNotEqual(status, util.SUCCESS, output)
+
+    def runDFilterSet(self, dfilters):
+        # Each io,stat column is a tap listener with its own filter,
+        # and tap listener filters are applied together as a set.
+        cmdv = [TSHARK,
+                "-n",       # No name resolution
+                "-q",       # Only print the statistics
+                "-r",       # Next arg is trace file to read
+                self.trace_file,
+                "-z",
+                "io,stat,0," + ",".join(dfilters)]
+
+        (status, output) = util.exec_cmdv(cmdv)
+        return status, output
+
+    def assertDFilterSetCounts(self, dfilters, expected_counts):
+        """Run display filters as a filter set and expect a certain
+        number of packets for each of them."""
+
+        (status, output) = self.runDFilterSet(dfilters)
+
+        # tshark must succeed
+        self.assertEqual(status, util.SUCCESS, output)
+
+        # There's only one interval. Its row has the frame and byte
+        # counts of each column in turn.
+        rows = [L for L in output.split("\n") if "<>" in L]
+        self.assertEqual(len(rows), 1, output)
+        cells = [c.strip() for c in rows[0].split("|") if c.strip() != ""]
+        counts = [int(c) for c in cells[1::2]]
+
+        msg = "Expected %s, got: %s" % (expected_counts, output)
+        self.assertEqual(counts, expected_counts, msg)
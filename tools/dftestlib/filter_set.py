@@ -0,0 +1,36 @@
+# Copyright (c) 2013 by Gilbert Ramirez <gram@alumni.rice.edu>
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+
+from dftestlib import dftest
+
+class testFilterSet(dftest.DFTest):
+    trace_file = "nfs.pcap"
+
+    def test_two_fields_1(self):
+        dfilters = ["ip.src==172.25.100.14&&ip.dst==198.95.230.20",
+                    "ip.src==ip.dst"]
+        self.assertDFilterSetCounts(dfilters, [1, 0])
+
+    def test_two_fields_2(self):
+        dfilters = ["ip.src!=ip.dst"]
+        self.assertDFilterSetCounts(dfilters, [2])
+
+    def test_shared_field_1(self):
+        dfilters = ["ip.src==172.25.100.14",
+                    "ip.src!=172.25.100.14"]
+        self.assertDFilterSetCounts(dfilters, [1, 1])
+
+    def test_shared_field_2(self):
+        dfilters = ["ip.src==172.25.100.14&&ip.dst==198.95.230.20",
+                    "ip.src==172.25.100.14",
+                    "ip.src!=ip.dst",
+                    "ip.dst>=198.95.230.20"]
+        self.assertDFilterSetCounts(dfilters, [1, 1, 2, 1])
+
+    def test_shared_missing_field_1(self):
+        dfilters = ["ip.src==255.255.255.255",
+                    "nfs.fattr3.size==264032",
+                    "ip.src==255.255.255.255&&nfs.fattr3.size==264032"]
+        self.assertDFilterSetCounts(dfilters, [0, 1, 0])
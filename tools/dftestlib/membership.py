@@ -45,3 +45,17 @@ class testMembership(dftest.DFTest):
         # expression should be parsed as "0.1 .. .7"
         dfilter = 'frame.time_delta in {0.1...7}'
         self.assertDFilterCount(dfilter, 0)
+
+    def test_membership_10_uint_set_match(self):
+        # Unordered set of integers, evaluated as a sorted constant set.
+        dfilter = 'tcp.port in {443 3267 22 80}'
+        self.assertDFilterCount(dfilter, 1)
+
+    def test_membership_11_uint_set_no_match(self):
+        dfilter = 'tcp.dstport in {1 2 3 4 5}'
+        self.assertDFilterCount(dfilter, 0)
+
+    def test_membership_12_uint_set_and_range(self):
+        # Sets with ranges are not folded, but must give the same result.
+        dfilter = 'tcp.dstport in {1 2 3 4 75..85}'
+        self.assertDFilterCount(dfilter, 1)
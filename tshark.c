@@ -145,6 +145,7 @@
 #ifdef HAVE_JSONGLIB
 #define LONGOPT_ELASTIC_MAPPING_FILTER (65536+1002)
 #endif
+#define LONGOPT_READ_AHEAD (65536+1003)
 
 #if 0
 #define tshark_debug(...) g_warning(__VA_ARGS__)
@@ -162,6 +163,8 @@ static frame_data prev_cap_frame;
 static gboolean perform_two_pass_analysis;
 static guint32 epan_auto_reset_count = 0;
 static gboolean epan_auto_reset = FALSE;
+static gboolean read_ahead = FALSE;         /* TRUE to read on a separate thread for the first pass */
+static gboolean read_ahead_active = FALSE;  /* TRUE while that thread is reading */
 
 /*
  * The way the packet decode is to be written.
@@ -443,6 +446,8 @@ print_usage(FILE *output)
   fprintf(output, "  --no-duplicate-keys      If -T json is specified, merge duplicate keys in an object\n");
   fprintf(output, "                           into a single key with as value a json array containing all\n");
   fprintf(output, "                           values\n");
+  fprintf(output, "  --read-ahead             with -2, read the capture file on a separate thread\n");
+  fprintf(output, "                           during the first pass\n");
 #ifdef HAVE_JSONGLIB
   fprintf(output, "  --elastic-mapping-filter <protocols> If -G elastic-mapping is specified, put only the\n");
   fprintf(output, "                           specified protocols within the mapping file\n");
@@ -687,6 +692,7 @@ main(int argc, char *argv[])
     {"export-objects", required_argument, NULL, LONGOPT_EXPORT_OBJECTS},
     {"color", no_argument, NULL, LONGOPT_COLOR},
     {"no-duplicate-keys", no_argument, NULL, LONGOPT_NO_DUPLICATE_KEYS},
+    {"read-ahead", no_argument, NULL, LONGOPT_READ_AHEAD},
 #ifdef HAVE_JSONGLIB
     {"elastic-mapping-filter", required_argument, NULL, LONGOPT_ELASTIC_MAPPING_FILTER},
 #endif
@@ -1470,6 +1476,9 @@ main(int argc, char *argv[])
       no_duplicate_keys = TRUE;
       node_children_grouper = proto_node_group_children_by_json_key;
       break;
+    case LONGOPT_READ_AHEAD:
+      read_ahead = TRUE;
+      break;
     default:
     case '?':        /* Bad flag - print usage message */
       switch(optopt) {
@@ -1500,6 +1509,12 @@ main(int argc, char *argv[])
     goto clean_exit;
   }
 
+  if (read_ahead && !perform_two_pass_analysis) {
+    cmdarg_err("--read-ahead can only be used with -2");
+    exit_status = INVALID_OPTION;
+    goto clean_exit;
+  }
+
   /* If we specified output fields, but not the output field type... */
   if ((WRITE_FIELDS != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action) && 0 != output_fields_num_fields(output_fields)) {
         cmdarg_err("Output fields were specified with \"-e\", "
@@ -2381,13 +2396,359 @@ tshark_get_frame_ts(struct packet_provider_data *prov, guint32 frame_num)
   return NULL;
 }
 
+/*
+ * Read-ahead for the first pass of a two-pass analysis.
+ *
+ * With --read-ahead, a separate thread does the wiretap reading (and,
+ * for compressed files, the decompression) for the first pass, copying
+ * records into batches that are handed to the main thread through a
+ * GAsyncQueue.  The main thread still creates the frame_data and does
+ * all of the dissection, in frame order, as dissection isn't thread-safe;
+ * this lets reading a record overlap with dissecting the previous ones.
+ *
+ * Batches are recycled through a second queue, which bounds the amount
+ * of data read ahead to READ_AHEAD_NUM_BATCHES * READ_AHEAD_BATCH_SIZE
+ * records.
+ */
+#define READ_AHEAD_BATCH_SIZE   256
+#define READ_AHEAD_NUM_BATCHES  8
+
+typedef struct {
+  gint64    data_offset;
+  wtap_rec  rec;
+  Buffer    buf;
+} read_ahead_record_t;
+
+/*
+ * A host name from a name resolution block, seen by the read thread; it's
+ * handed to addr_resolv by the main thread.
+ */
+typedef struct {
+  gboolean      is_ipv6;
+  guint         ipv4_addr;
+  ws_in6_addr   ipv6_addr;
+  gchar        *name;
+} read_ahead_name_t;
+
+/*
+ * The name and description of an interface, from its IDB; the strings
+ * belong to the wtap, which doesn't free IDBs while the file is open.
+ */
+typedef struct {
+  const char   *name;
+  const char   *description;
+} read_ahead_iface_t;
+
+typedef struct {
+  read_ahead_record_t records[READ_AHEAD_BATCH_SIZE];
+  guint     count;
+  GArray   *names;      /* read_ahead_name_t seen while filling this batch */
+  GArray   *ifaces;     /* read_ahead_iface_t for all IDBs seen by the end of this batch */
+  gboolean  last;       /* TRUE if no batches follow this one */
+  int       err;        /* for the last batch, the error, if any */
+  gchar    *err_info;
+} read_ahead_batch_t;
+
+typedef struct {
+  wtap         *wth;
+  GAsyncQueue  *free_q;     /* batches available to the read thread */
+  GAsyncQueue  *filled_q;   /* batches available to the main thread */
+  gint          stop;       /* set by the main thread to stop reading */
+  GThread      *thread;
+  read_ahead_batch_t batches[READ_AHEAD_NUM_BATCHES];
+} read_ahead_t;
+
+/*
+ * While reading ahead, the read thread is the only user of the wtap; the
+ * main thread looks up interface information in the snapshot of the IDBs
+ * that came with the batch it's dissecting, which covers every interface
+ * its records can refer to.
+ */
+static GArray *read_ahead_ifaces;
+
+/*
+ * Provider handed to frame_tvbuff_new() on the first pass when reading
+ * ahead; it has no wtap, so tvbuffs are never backed by seek-reads on
+ * the random stream while the read thread owns the sequential one.
+ */
+static const struct packet_provider_data read_ahead_tvb_provider;
+
+/* The batch being filled by the read thread; only touched by that thread. */
+static read_ahead_batch_t *read_ahead_fill_batch;
+
+static void
+read_ahead_add_ipv4_name(const guint addr, const gchar *name)
+{
+  read_ahead_name_t entry;
+
+  memset(&entry, 0, sizeof entry);
+  entry.is_ipv6 = FALSE;
+  entry.ipv4_addr = addr;
+  entry.name = g_strdup(name);
+  g_array_append_val(read_ahead_fill_batch->names, entry);
+}
+
+static void
+read_ahead_add_ipv6_name(const void *addrp, const gchar *name)
+{
+  read_ahead_name_t entry;
+
+  memset(&entry, 0, sizeof entry);
+  entry.is_ipv6 = TRUE;
+  memcpy(&entry.ipv6_addr, addrp, sizeof entry.ipv6_addr);
+  entry.name = g_strdup(name);
+  g_array_append_val(read_ahead_fill_batch->names, entry);
+}
+
+/*
+ * Copy the record most recently read by wtap_read() into a batch slot,
+ * reusing the slot's buffers.
+ */
+static void
+read_ahead_copy_record(read_ahead_record_t *slot, wtap *wth, gint64 data_offset)
+{
+  wtap_rec *rec = wtap_get_rec(wth);
+  Buffer    options_buf = slot->rec.options_buf;
+  guint32   data_len;
+
+  switch (rec->rec_type) {
+
+  case REC_TYPE_PACKET:
+    data_len = rec->rec_header.packet_header.caplen;
+    break;
+
+  case REC_TYPE_SYSCALL:
+    data_len = rec->rec_header.syscall_header.event_filelen;
+    break;
+
+  default:
+    /* As in frame_data_init(), there's no packet data for these. */
+    data_len = 0;
+    break;
+  }
+
+  slot->data_offset = data_offset;
+  slot->rec = *rec;
+  slot->rec.options_buf = options_buf;
+  ws_buffer_clean(&slot->rec.options_buf);
+  ws_buffer_append_buffer(&slot->rec.options_buf, &rec->options_buf);
+
+  ws_buffer_clean(&slot->buf);
+  ws_buffer_append(&slot->buf, wtap_get_buf_ptr(wth), data_len);
+}
+
+/*
+ * Take a snapshot of the interface names and descriptions for the batch
+ * that has just been filled.
+ */
+static void
+read_ahead_snapshot_ifaces(read_ahead_batch_t *batch, wtap *wth)
+{
+  wtapng_iface_descriptions_t *idb_info;
+  wtap_block_t        wtapng_if_descr;
+  read_ahead_iface_t  iface;
+  char               *value;
+  guint               i;
+
+  idb_info = wtap_file_get_idb_info(wth);
+  g_array_set_size(batch->ifaces, 0);
+  for (i = 0; i < idb_info->interface_data->len; i++) {
+    wtapng_if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
+    iface.name = NULL;
+    iface.description = NULL;
+    if (wtap_block_get_string_option_value(wtapng_if_descr, OPT_IDB_NAME, &value) == WTAP_OPTTYPE_SUCCESS)
+      iface.name = value;
+    if (wtap_block_get_string_option_value(wtapng_if_descr, OPT_IDB_DESCR, &value) == WTAP_OPTTYPE_SUCCESS)
+      iface.description = value;
+    g_array_append_val(batch->ifaces, iface);
+  }
+  g_free(idb_info);
+}
+
+static gpointer
+read_ahead_thread(gpointer data)
+{
+  read_ahead_t       *ra = (read_ahead_t *)data;
+  read_ahead_batch_t *batch;
+  gint64              data_offset;
+  int                 err = 0;
+  gchar              *err_info = NULL;
+  gboolean            more = TRUE;
+
+  while (more) {
+    batch = (read_ahead_batch_t *)g_async_queue_pop(ra->free_q);
+    batch->count = 0;
+    read_ahead_fill_batch = batch;
+
+    while (batch->count < READ_AHEAD_BATCH_SIZE) {
+      if (g_atomic_int_get(&ra->stop) ||
+          !wtap_read(ra->wth, &err, &err_info, &data_offset)) {
+        more = FALSE;
+        break;
+      }
+      read_ahead_copy_record(&batch->records[batch->count], ra->wth, data_offset);
+      batch->count++;
+    }
+    read_ahead_snapshot_ifaces(batch, ra->wth);
+
+    if (!more) {
+      batch->last = TRUE;
+      batch->err = err;
+      batch->err_info = err_info;
+    }
+    g_async_queue_push(ra->filled_q, batch);
+  }
+
+  read_ahead_fill_batch = NULL;
+  return NULL;
+}
+
+/*
+ * Start reading ahead on wth.  The batches are too big for the stack,
+ * so the read_ahead_t is allocated here and freed by read_ahead_finish().
+ */
+static read_ahead_t *
+read_ahead_start(wtap *wth)
+{
+  read_ahead_t *ra;
+  guint i, j;
+
+  ra = g_new0(read_ahead_t, 1);
+  ra->wth = wth;
+  ra->free_q = g_async_queue_new();
+  ra->filled_q = g_async_queue_new();
+  ra->stop = 0;
+
+  for (i = 0; i < READ_AHEAD_NUM_BATCHES; i++) {
+    read_ahead_batch_t *batch = &ra->batches[i];
+
+    for (j = 0; j < READ_AHEAD_BATCH_SIZE; j++) {
+      wtap_rec_init(&batch->records[j].rec);
+      ws_buffer_init(&batch->records[j].buf, 1514);
+    }
+    batch->count = 0;
+    batch->names = g_array_new(FALSE, FALSE, sizeof(read_ahead_name_t));
+    batch->ifaces = g_array_new(FALSE, FALSE, sizeof(read_ahead_iface_t));
+    batch->last = FALSE;
+    batch->err = 0;
+    batch->err_info = NULL;
+    g_async_queue_push(ra->free_q, batch);
+  }
+
+  wtap_set_cb_new_ipv4(wth, read_ahead_add_ipv4_name);
+  wtap_set_cb_new_ipv6(wth, read_ahead_add_ipv6_name);
+  read_ahead_active = TRUE;
+
+  ra->thread = g_thread_new("tshark_read_ahead", read_ahead_thread, ra);
+  return ra;
+}
+
+/*
+ * Get the next batch of records from the read thread, handing it any
+ * host names it found in name resolution blocks along the way.
+ */
+static read_ahead_batch_t *
+read_ahead_next_batch(read_ahead_t *ra)
+{
+  read_ahead_batch_t *batch;
+  guint i;
+
+  batch = (read_ahead_batch_t *)g_async_queue_pop(ra->filled_q);
+  for (i = 0; i < batch->names->len; i++) {
+    read_ahead_name_t *entry = &g_array_index(batch->names, read_ahead_name_t, i);
+
+    if (entry->is_ipv6)
+      add_ipv6_name(&entry->ipv6_addr, entry->name);
+    else
+      add_ipv4_name(entry->ipv4_addr, entry->name);
+    g_free(entry->name);
+  }
+  g_array_set_size(batch->names, 0);
+  read_ahead_ifaces = batch->ifaces;
+  return batch;
+}
+
+static void
+read_ahead_release_batch(read_ahead_t *ra, read_ahead_batch_t *batch)
+{
+  g_async_queue_push(ra->free_q, batch);
+}
+
+/*
+ * Stop the read thread, if it hasn't already hit the end of the file,
+ * and free everything.  "batch" is the batch the main thread is holding,
+ * if any; if it's the last batch, the read thread has already exited.
+ */
+static void
+read_ahead_finish(read_ahead_t *ra, read_ahead_batch_t *batch)
+{
+  guint i, j;
+
+  g_atomic_int_set(&ra->stop, 1);
+  while (batch == NULL || !batch->last) {
+    if (batch != NULL)
+      read_ahead_release_batch(ra, batch);
+    batch = read_ahead_next_batch(ra);
+  }
+  g_free(batch->err_info);
+  g_thread_join(ra->thread);
+
+  read_ahead_active = FALSE;
+  read_ahead_ifaces = NULL;
+  wtap_set_cb_new_ipv4(ra->wth, add_ipv4_name);
+  wtap_set_cb_new_ipv6(ra->wth, (wtap_new_ipv6_callback_t) add_ipv6_name);
+
+  for (i = 0; i < READ_AHEAD_NUM_BATCHES; i++) {
+    for (j = 0; j < READ_AHEAD_BATCH_SIZE; j++) {
+      wtap_rec_cleanup(&ra->batches[i].records[j].rec);
+      ws_buffer_free(&ra->batches[i].records[j].buf);
+    }
+    g_array_free(ra->batches[i].names, TRUE);
+    g_array_free(ra->batches[i].ifaces, TRUE);
+  }
+  g_async_queue_unref(ra->free_q);
+  g_async_queue_unref(ra->filled_q);
+  g_free(ra);
+}
+
+static const char *
+tshark_get_interface_name(struct packet_provider_data *prov, guint32 interface_id)
+{
+  const read_ahead_iface_t *iface;
+
+  if (!read_ahead_active)
+    return cap_file_provider_get_interface_name(prov, interface_id);
+
+  /* As cap_file_provider_get_interface_name() does, from the snapshot. */
+  if (interface_id < read_ahead_ifaces->len) {
+    iface = &g_array_index(read_ahead_ifaces, read_ahead_iface_t, interface_id);
+    if (iface->name)
+      return iface->name;
+    if (iface->description)
+      return iface->description;
+  }
+  return "unknown";
+}
+
+static const char *
+tshark_get_interface_description(struct packet_provider_data *prov, guint32 interface_id)
+{
+  if (!read_ahead_active)
+    return cap_file_provider_get_interface_description(prov, interface_id);
+
+  if (interface_id < read_ahead_ifaces->len)
+    return g_array_index(read_ahead_ifaces, read_ahead_iface_t, interface_id).description;
+  return NULL;
+}
+
 static epan_t *
 tshark_epan_new(capture_file *cf)
 {
   static const struct packet_provider_funcs funcs = {
     tshark_get_frame_ts,
-    cap_file_provider_get_interface_name,
-    cap_file_provider_get_interface_description,
+    tshark_get_interface_name,
+    tshark_get_interface_description,
+    NULL,
     NULL,
   };
 
@@ -2932,7 +3293,8 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
     }
 
     epan_dissect_run(edt, cf->cd_t, rec,
-                     frame_tvbuff_new(&cf->provider, &fdlocal, pd),
+                     frame_tvbuff_new(read_ahead_active ? &read_ahead_tvb_provider : &cf->provider,
+                                      &fdlocal, pd),
                      &fdlocal, NULL);
 
     /* Run the read filter if we have one. */
@@ -3199,19 +3561,57 @@ process_cap_file(capture_file *cf, char *save_file, int out_file_type,
     }
 
     tshark_debug("tshark: reading records for first pass");
-    while (wtap_read(cf->provider.wth, &err, &err_info, &data_offset)) {
-      if (process_packet_first_pass(cf, edt, data_offset, wtap_get_rec(cf->provider.wth),
-                                    wtap_get_buf_ptr(cf->provider.wth))) {
-        /* Stop reading if we have the maximum number of packets;
-         * When the -c option has not been used, max_packet_count
-         * starts at 0, which practically means, never stop reading.
-         * (unless we roll over max_packet_count ?)
-         */
-        if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count)) {
-          tshark_debug("tshark: max_packet_count (%d) or max_byte_count (%" G_GINT64_MODIFIER "d/%" G_GINT64_MODIFIER "d) reached",
-                        max_packet_count, data_offset, max_byte_count);
-          err = 0; /* This is not an error */
+    if (read_ahead) {
+      read_ahead_t       *ra;
+      read_ahead_batch_t *batch = NULL;
+      gboolean            done = FALSE;
+      guint               i;
+
+      tshark_debug("tshark: reading ahead on a separate thread");
+      ra = read_ahead_start(cf->provider.wth);
+      while (!done) {
+        batch = read_ahead_next_batch(ra);
+        for (i = 0; i < batch->count; i++) {
+          read_ahead_record_t *record = &batch->records[i];
+
+          if (process_packet_first_pass(cf, edt, record->data_offset, &record->rec,
+                                        ws_buffer_start_ptr(&record->buf))) {
+            /* Stop reading if we have the maximum number of packets, as below. */
+            if ( (--max_packet_count == 0) || (max_byte_count != 0 && record->data_offset >= max_byte_count)) {
+              tshark_debug("tshark: max_packet_count (%d) or max_byte_count (%" G_GINT64_MODIFIER "d/%" G_GINT64_MODIFIER "d) reached",
+                            max_packet_count, record->data_offset, max_byte_count);
+              done = TRUE;
+              break;
+            }
+          }
+        }
+        if (done)
           break;
+        if (batch->last) {
+          err = batch->err;
+          err_info = batch->err_info;
+          batch->err_info = NULL;
+          break;
+        }
+        read_ahead_release_batch(ra, batch);
+        batch = NULL;
+      }
+      read_ahead_finish(ra, batch);
+    } else {
+      while (wtap_read(cf->provider.wth, &err, &err_info, &data_offset)) {
+        if (process_packet_first_pass(cf, edt, data_offset, wtap_get_rec(cf->provider.wth),
+                                      wtap_get_buf_ptr(cf->provider.wth))) {
+          /* Stop reading if we have the maximum number of packets;
+           * When the -c option has not been used, max_packet_count
+           * starts at 0, which practically means, never stop reading.
+           * (unless we roll over max_packet_count ?)
+           */
+          if ( (--max_packet_count == 0) || (max_byte_count != 0 && data_offset >= max_byte_count)) {
+            tshark_debug("tshark: max_packet_count (%d) or max_byte_count (%" G_GINT64_MODIFIER "d/%" G_GINT64_MODIFIER "d) reached",
+                          max_packet_count, data_offset, max_byte_count);
+            err = 0; /* This is not an error */
+            break;
+          }
         }
       }
     }
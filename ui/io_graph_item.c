@@ -124,6 +124,110 @@ GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_u
     return err_str;
 }
 
+#define IOG_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index, int item_unit)
+{
+    int max_cmp, min_cmp; /* > 0 and < 0 respectively if src holds the new extreme */
+
+    if (src->first_frame_in_invl != 0 &&
+        (dst->first_frame_in_invl == 0 || src->first_frame_in_invl < dst->first_frame_in_invl)) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl > dst->last_frame_in_invl) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+
+    dst->frames     += src->frames;
+    dst->bytes      += src->bytes;
+    dst->int_tot    += src->int_tot;
+    dst->float_tot  += src->float_tot;
+    dst->double_tot += src->double_tot;
+    /* LOAD adds to earlier intervals, so this might be set without any fields */
+    nstime_add(&dst->time_tot, &src->time_tot);
+
+    if (src->fields == 0) {
+        return;
+    }
+
+    if (dst->fields == 0) {
+        dst->int_max    = src->int_max;
+        dst->int_min    = src->int_min;
+        dst->float_max  = src->float_max;
+        dst->float_min  = src->float_min;
+        dst->double_max = src->double_max;
+        dst->double_min = src->double_min;
+        dst->time_max   = src->time_max;
+        dst->time_min   = src->time_min;
+        dst->extreme_frame_in_invl = src->extreme_frame_in_invl;
+        dst->fields     = src->fields;
+        return;
+    }
+
+    switch (hf_index >= 0 ? proto_registrar_get_ftype(hf_index) : FT_NONE) {
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_UINT40:
+    case FT_UINT48:
+    case FT_UINT56:
+    case FT_UINT64:
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+    case FT_INT40:
+    case FT_INT48:
+    case FT_INT56:
+    case FT_INT64:
+        max_cmp = IOG_CMP(src->int_max, dst->int_max);
+        min_cmp = IOG_CMP(src->int_min, dst->int_min);
+        break;
+    case FT_FLOAT:
+        max_cmp = IOG_CMP(src->float_max, dst->float_max);
+        min_cmp = IOG_CMP(src->float_min, dst->float_min);
+        break;
+    case FT_DOUBLE:
+        max_cmp = IOG_CMP(src->double_max, dst->double_max);
+        min_cmp = IOG_CMP(src->double_min, dst->double_min);
+        break;
+    case FT_RELATIVE_TIME:
+        max_cmp = nstime_cmp(&src->time_max, &dst->time_max);
+        min_cmp = nstime_cmp(&src->time_min, &dst->time_min);
+        break;
+    default:
+        max_cmp = min_cmp = 0;
+        break;
+    }
+
+    /*
+     * update_io_graph_item keeps the first frame that reached the extreme,
+     * and frames are tapped in order, so on a tie the lower frame wins.
+     */
+    if (item_unit == IOG_ITEM_UNIT_CALC_MAX &&
+        (max_cmp > 0 || (max_cmp == 0 && src->extreme_frame_in_invl < dst->extreme_frame_in_invl))) {
+        dst->extreme_frame_in_invl = src->extreme_frame_in_invl;
+    } else if (item_unit == IOG_ITEM_UNIT_CALC_MIN &&
+        (min_cmp < 0 || (min_cmp == 0 && src->extreme_frame_in_invl < dst->extreme_frame_in_invl))) {
+        dst->extreme_frame_in_invl = src->extreme_frame_in_invl;
+    }
+
+    dst->int_max    = MAX(dst->int_max, src->int_max);
+    dst->int_min    = MIN(dst->int_min, src->int_min);
+    dst->float_max  = MAX(dst->float_max, src->float_max);
+    dst->float_min  = MIN(dst->float_min, src->float_min);
+    dst->double_max = MAX(dst->double_max, src->double_max);
+    dst->double_min = MIN(dst->double_min, src->double_min);
+    if (nstime_cmp(&src->time_max, &dst->time_max) > 0) {
+        dst->time_max = src->time_max;
+    }
+    if (nstime_cmp(&src->time_min, &dst->time_min) < 0) {
+        dst->time_min = src->time_min;
+    }
+    dst->fields += src->fields;
+}
+
 /*
  * Editor modelines
  *
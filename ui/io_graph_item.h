@@ -111,6 +111,13 @@ int get_io_graph_index(packet_info *pinfo, int interval);
  */
 GString *check_field_unit(const char *field_name, int *hf_index, io_graph_item_unit_t item_unit);
 
+/* Fold the values of one interval into another, e.g. to turn several
+ * consecutive intervals into one that spans all of them. Both items must
+ * have been filled in by update_io_graph_item with the same hf_index and
+ * item_unit. Merging every item of an interval in ascending order gives
+ * the same result as tapping at the longer interval. */
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index, int item_unit);
+
 /** Update the values of an io_graph_item_t.
  *
  * Frame and byte counts are always calculated. If edt is non-NULL advanced
@@ -1160,8 +1160,7 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
         for (int row = 0; row < uat_model_->rowCount(); row++) {
             IOGraph *iog = ioGraphs_.value(row, NULL);
             if (iog) {
-                iog->setInterval(interval);
-                if (iog->visible()) {
+                if (!iog->setInterval(interval) && iog->visible()) {
                     need_retap = true;
                 }
             }
@@ -1170,6 +1169,8 @@ void IOGraphDialog::on_intervalComboBox_currentIndexChanged(int)
 
     if (need_retap) {
         scheduleRetap(true);
+    } else {
+        scheduleRecalc(true);
     }
 
     updateLegend();
@@ -1492,7 +1493,9 @@ IOGraph::IOGraph(QCustomPlot *parent) :
     bars_(NULL),
     val_units_(IOG_ITEM_UNIT_FIRST),
     hf_index_(-1),
-    cur_idx_(-1)
+    interval_(0),
+    cur_idx_(-1),
+    items_truncated_(false)
 {
     Q_ASSERT(parent_ != NULL);
     graph_ = parent_->addGraph(parent_->xAxis, parent_->yAxis);
@@ -1778,6 +1781,7 @@ int IOGraph::packetFromTime(double ts)
 void IOGraph::clearAllData()
 {
     cur_idx_ = -1;
+    items_truncated_ = false;
     reset_io_graph_items(items_, max_io_items_);
     if (graph_) {
         graph_->clearData();
@@ -1976,9 +1980,38 @@ void IOGraph::reloadValueUnitField()
     }
 }
 
-void IOGraph::setInterval(int interval)
+// Returns false if the items we have can't be converted to the new
+// interval, in which case we need to be retapped.
+bool IOGraph::setInterval(int interval)
 {
+    int old_interval = interval_;
+
+    if (interval == old_interval) {
+        return true;
+    }
     interval_ = interval;
+
+    // A longer interval that's a multiple of the old one can be built by
+    // merging items, unless we ran out of them while tapping. All of the
+    // intervals in the combo box are multiples of the shorter ones.
+    if (cur_idx_ < 0 || items_truncated_ || old_interval <= 0 ||
+            interval < old_interval || interval % old_interval != 0) {
+        return false;
+    }
+
+    int factor = interval / old_interval;
+    int new_cur_idx = cur_idx_ / factor;
+    for (int idx = 0; idx <= new_cur_idx; idx++) {
+        io_graph_item_t item;
+        reset_io_graph_items(&item, 1);
+        for (int old_idx = idx * factor; old_idx < (idx + 1) * factor && old_idx <= cur_idx_; old_idx++) {
+            merge_io_graph_item(&item, &items_[old_idx], hf_index_, val_units_);
+        }
+        items_[idx] = item;
+    }
+    reset_io_graph_items(&items_[new_cur_idx + 1], cur_idx_ - new_cur_idx);
+    cur_idx_ = new_cur_idx;
+    return true;
 }
 
 // Get the value at the given interval (idx) for the current value unit.
@@ -2158,6 +2191,7 @@ gboolean IOGraph::tapPacket(void *iog_ptr, packet_info *pinfo, epan_dissect_t *e
     /* some sanity checks */
     if ((idx < 0) || (idx >= max_io_items_)) {
         iog->cur_idx_ = max_io_items_ - 1;
+        iog->items_truncated_ = true;
         return FALSE;
     }
 
@@ -311,24 +311,46 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     QString col_title = get_column_title(column);
 
     busy_timer_.start();
-    emit pushProgressStatus(tr("Dissecting"), true, true, &stop_flag);
-    int row_num = 0;
-    foreach (PacketListRecord *row, physical_rows_) {
-        row->columnString(sort_cap_file_, column);
-        row_num++;
-        if (busy_timer_.elapsed() > busy_timeout_) {
-            if (stop_flag) {
-                emit popProgressStatus();
-                return;
+    sort_column_is_numeric_ = isNumericColumn(sort_column_);
+
+    // Columns that aren't based on frame data have to be dissected. Do that
+    // once per record up front and keep the column text (and its numeric
+    // value, if any) as a sort key, so that the comparisons don't have to
+    // go back to the records. The keys point into the string pool, so
+    // don't let it go away while we're processing events.
+    QVector<SortKey> sort_keys;
+    if (text_sort_column_ >= 0) {
+        PacketListRecord::holdStringPool();
+        emit pushProgressStatus(tr("Dissecting"), true, true, &stop_flag);
+        sort_keys.reserve(physical_rows_.count());
+        int row_num = 0;
+        foreach (PacketListRecord *row, physical_rows_) {
+            SortKey key;
+            key.record = row;
+            key.text = row->columnText(sort_cap_file_, column);
+            if (!key.text) key.text = "";
+            key.number = 0.0;
+            key.number_valid = false;
+            if (sort_column_is_numeric_) {
+                key.number = parseNumericColumn(key.text, &key.number_valid);
+            }
+            sort_keys << key;
+            row_num++;
+            if (busy_timer_.elapsed() > busy_timeout_) {
+                if (stop_flag) {
+                    emit popProgressStatus();
+                    PacketListRecord::releaseStringPool();
+                    return;
+                }
+                emit updateProgressStatus(row_num * 100 / physical_rows_.count());
+                // What's the least amount of processing that we can do which will draw
+                // the progress indicator?
+                wsApp->processEvents(QEventLoop::AllEvents, 1);
+                busy_timer_.restart();
             }
-            emit updateProgressStatus(row_num * 100 / physical_rows_.count());
-            // What's the least amount of processing that we can do which will draw
-            // the progress indicator?
-            wsApp->processEvents(QEventLoop::AllEvents, 1);
-            busy_timer_.restart();
         }
+        emit popProgressStatus();
     }
-    emit popProgressStatus();
 
     // XXX Use updateProgress instead. We'd have to switch from std::sort to
     // something we can interrupt.
@@ -338,8 +360,15 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     }
 
     busy_timer_.restart();
-    sort_column_is_numeric_ = isNumericColumn(sort_column_);
-    std::sort(physical_rows_.begin(), physical_rows_.end(), recordLessThan);
+    if (text_sort_column_ >= 0) {
+        std::sort(sort_keys.begin(), sort_keys.end(), sortKeyLessThan);
+        for (int i = 0; i < sort_keys.count(); i++) {
+            physical_rows_[i] = sort_keys[i].record;
+        }
+        PacketListRecord::releaseStringPool();
+    } else {
+        std::sort(physical_rows_.begin(), physical_rows_.end(), recordLessThan);
+    }
 
     beginResetModel();
     visible_rows_.resize(0);
@@ -401,58 +430,69 @@ bool PacketListModel::isNumericColumn(int column)
     return true;
 }
 
-bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
+// Draws the busy indicator now and then while we're sorting.
+void PacketListModel::sortProcessEvents()
 {
-    int cmp_val = 0;
-
-    // Wherein we try to cram the logic of packet_list_compare_records,
-    // _packet_list_compare_records, and packet_list_compare_custom from
-    // gtk/packet_list_store.c into one function
-
     if (busy_timer_.elapsed() > busy_timeout_) {
         // What's the least amount of processing that we can do which will draw
         // the busy indicator?
         wsApp->processEvents(QEventLoop::ExcludeUserInputEvents | QEventLoop::ExcludeSocketNotifiers, 1);
         busy_timer_.restart();
     }
+}
+
+// Columns based on frame data.
+bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
+{
+    int cmp_val = 0;
+
+    // Wherein we try to cram the logic of packet_list_compare_records,
+    // _packet_list_compare_records, and packet_list_compare_custom from
+    // gtk/packet_list_store.c into this function and sortKeyLessThan.
+
+    sortProcessEvents();
     if (sort_column_ < 0) {
         // No column.
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-    } else if (text_sort_column_ < 0) {
+    } else {
         // Column comes directly from frame data
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
-    } else  {
-        if (r1->columnString(sort_cap_file_, sort_column_).constData() == r2->columnString(sort_cap_file_, sort_column_).constData()) {
+    }
+
+    if (sort_order_ == Qt::AscendingOrder) {
+        return cmp_val < 0;
+    } else {
+        return cmp_val > 0;
+    }
+}
+
+// Columns that have to be dissected, using the keys built by sort.
+bool PacketListModel::sortKeyLessThan(const SortKey &k1, const SortKey &k2)
+{
+    int cmp_val = 0;
+
+    sortProcessEvents();
+    if (k1.text == k2.text) {
+        // Column text is interned, so equal strings usually end up here.
+        cmp_val = 0;
+    } else if (sort_column_is_numeric_) {
+        // Column comes from custom data and was converted to a number.
+        if (!k1.number_valid && !k2.number_valid) {
             cmp_val = 0;
-        } else if (sort_cap_file_->cinfo.columns[sort_column_].col_fmt == COL_CUSTOM) {
-            // Column comes from custom data
-            if (sort_column_is_numeric_) {
-                // Attempt to convert to numbers.
-                // XXX This is slow. Can we avoid doing this?
-                bool ok_r1, ok_r2;
-                double num_r1 = parseNumericColumn(r1->columnString(sort_cap_file_, sort_column_), &ok_r1);
-                double num_r2 = parseNumericColumn(r2->columnString(sort_cap_file_, sort_column_), &ok_r2);
-
-                if (!ok_r1 && !ok_r2) {
-                    cmp_val = 0;
-                } else if (!ok_r1 || (ok_r2 && num_r1 < num_r2)) {
-                    // either r1 is invalid (and sort it before others) or both
-                    // r1 and r2 are valid (sort normally)
-                    cmp_val = -1;
-                } else if (!ok_r2 || (ok_r1 && num_r1 > num_r2)) {
-                    cmp_val = 1;
-                }
-            } else {
-                cmp_val = strcmp(r1->columnString(sort_cap_file_, sort_column_).constData(), r2->columnString(sort_cap_file_, sort_column_).constData());
-            }
-        } else {
-            cmp_val = strcmp(r1->columnString(sort_cap_file_, sort_column_).constData(), r2->columnString(sort_cap_file_, sort_column_).constData());
+        } else if (!k1.number_valid || (k2.number_valid && k1.number < k2.number)) {
+            // either k1 is invalid (and sort it before others) or both
+            // k1 and k2 are valid (sort normally)
+            cmp_val = -1;
+        } else if (!k2.number_valid || (k1.number_valid && k1.number > k2.number)) {
+            cmp_val = 1;
         }
+    } else {
+        cmp_val = strcmp(k1.text, k2.text);
+    }
 
-        if (cmp_val == 0) {
-            // All else being equal, compare column numbers.
-            cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), COL_NUMBER);
-        }
+    if (cmp_val == 0) {
+        // All else being equal, compare column numbers.
+        cmp_val = frame_data_compare(sort_cap_file_->epan, k1.record->frameData(), k2.record->frameData(), COL_NUMBER);
     }
 
     if (sort_order_ == Qt::AscendingOrder) {
@@ -465,13 +505,11 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
 // Parses a field as a double. Handle values with suffixes ("12ms"), negative
 // values ("-1.23") and fields with multiple occurrences ("1,2"). Marks values
 // that do not contain any numeric value ("Unknown") as invalid.
-double PacketListModel::parseNumericColumn(const QString &val, bool *ok)
+double PacketListModel::parseNumericColumn(const char *val, bool *ok)
 {
-    QByteArray ba = val.toUtf8();
-    const char *strval = ba.constData();
     gchar *end = NULL;
-    double num = g_ascii_strtod(strval, &end);
-    *ok = strval != end;
+    double num = g_ascii_strtod(val, &end);
+    *ok = val != end;
     return num;
 }
 
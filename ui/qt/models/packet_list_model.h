@@ -104,8 +104,17 @@ private:
     static int text_sort_column_;
     static Qt::SortOrder sort_order_;
     static capture_file *sort_cap_file_;
+    // Sort key for columns that have to be dissected.
+    struct SortKey {
+        PacketListRecord *record;
+        const char *text;   // Interned; see PacketListRecord::columnText
+        double number;
+        bool number_valid;
+    };
+    static void sortProcessEvents();
     static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
-    static double parseNumericColumn(const QString &val, bool *ok);
+    static bool sortKeyLessThan(const SortKey &k1, const SortKey &k2);
+    static double parseNumericColumn(const char *val, bool *ok);
 
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
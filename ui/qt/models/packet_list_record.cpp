@@ -22,21 +22,13 @@
 
 #include <QStringList>
 
-class ColumnTextList : public QList<const char *> {
-public:
-    // Allocate our records using wmem.
-    static void *operator new(size_t size) {
-        return wmem_alloc(wmem_file_scope(), size);
-    }
-
-    static void operator delete(void *) {}
-};
-
 QMap<int, int> PacketListRecord::cinfo_column_;
 unsigned PacketListRecord::col_data_ver_ = 1;
 
 PacketListRecord::PacketListRecord(frame_data *frameData) :
     col_text_(0),
+    col_text_len_(0),
+    col_text_alloc_(0),
     fdata_(frameData),
     lines_(1),
     line_count_changed_(false),
@@ -51,23 +43,46 @@ void *PacketListRecord::operator new(size_t size)
     return wmem_alloc(wmem_file_scope(), size);
 }
 
-// We might want to return a const char * instead. This would keep us from
-// creating excessive QByteArrays, e.g. in PacketListModel::recordLessThan.
+// The returned array points into the string pool. Like columnText, it's
+// only valid until the column strings are invalidated.
 const QByteArray PacketListRecord::columnString(capture_file *cap_file, int column, bool colorized)
+{
+    const char *text = columnText(cap_file, column, colorized);
+
+    if (!text) {
+        return QByteArray();
+    }
+    return QByteArray::fromRawData(text, (int) strlen(text));
+}
+
+// Returns the interned column text (see cacheColumnStrings), so equal
+// strings share a pointer. It stays valid until the string pool is
+// cleared, which happens when the column strings are invalidated.
+const char *PacketListRecord::columnText(capture_file *cap_file, int column, bool colorized)
 {
     // packet_list_store.c:packet_list_get_value
     g_assert(fdata_);
 
     if (!cap_file || column < 0 || column > cap_file->cinfo.num_cols) {
-        return QByteArray();
+        return NULL;
     }
 
     bool dissect_color = colorized && !colorized_;
-    if (!col_text_ || column >= col_text_->size() || !col_text_->at(column) || data_ver_ != col_data_ver_ || dissect_color) {
+    if (column >= col_text_len_ || data_ver_ != col_data_ver_ || dissect_color) {
         dissect(cap_file, dissect_color);
     }
 
-    return col_text_->value(column, QByteArray());
+    if (column >= col_text_len_) {
+        return NULL;
+    }
+    return g_array_index(string_pool_entries_, StringPoolEntry, col_text_[column]).str;
+}
+
+void PacketListRecord::invalidateAllRecords()
+{
+    col_data_ver_++;
+    // Nothing refers to the old strings once every record is out of date.
+    clearStringPool();
 }
 
 void PacketListRecord::resetColumns(column_info *cinfo)
@@ -102,8 +117,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
     wtap_rec rec; /* Record metadata */
     Buffer buf;   /* Record data */
 
-    if (!col_text_) col_text_ = new ColumnTextList;
-    gboolean dissect_columns = col_text_->isEmpty() || data_ver_ != col_data_ver_;
+    gboolean dissect_columns = col_text_len_ == 0 || data_ver_ != col_data_ver_;
 
     if (!cap_file) {
         return;
@@ -194,15 +208,51 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
     ws_buffer_free(&buf);
 }
 
+// Column text is interned: each distinct string is stored once, and
+// records refer to it by its index in string_pool_entries_. Protocol,
+// address and similar columns repeat the same few strings over and over.
+//
 // This assumes only one packet list. We might want to move this to
 // PacketListModel (or replace this with a wmem allocator).
 struct _GStringChunk *PacketListRecord::string_pool_ = g_string_chunk_new(1 * 1024 * 1024);
+struct _GHashTable *PacketListRecord::string_pool_ids_ = g_hash_table_new(g_str_hash, g_str_equal);
+struct _GArray *PacketListRecord::string_pool_entries_ = g_array_new(FALSE, FALSE, sizeof(StringPoolEntry));
+int PacketListRecord::string_pool_holds_ = 0;
+
 void PacketListRecord::clearStringPool()
 {
+    // Someone (e.g. PacketListModel::sort) is holding on to pointers.
+    // The strings will be dropped the next time around.
+    if (string_pool_holds_ > 0) {
+        return;
+    }
+
+    g_hash_table_remove_all(string_pool_ids_);
+    g_array_set_size(string_pool_entries_, 0);
     g_string_chunk_clear(string_pool_);
 }
 
-//#define MINIMIZE_STRING_COPYING 1
+guint32 PacketListRecord::internString(const char *str)
+{
+    gpointer id;
+
+    if (g_hash_table_lookup_extended(string_pool_ids_, str, NULL, &id)) {
+        return GPOINTER_TO_UINT(id);
+    }
+
+    StringPoolEntry entry;
+    entry.str = g_string_chunk_insert(string_pool_, str);
+    entry.lines = 1;
+    for (int i = 0; str[i]; i++) {
+        if (str[i] == '\n') entry.lines++;
+    }
+
+    guint32 new_id = string_pool_entries_->len;
+    g_array_append_val(string_pool_entries_, entry);
+    g_hash_table_insert(string_pool_ids_, (gpointer) entry.str, GUINT_TO_POINTER(new_id));
+    return new_id;
+}
+
 void PacketListRecord::cacheColumnStrings(column_info *cinfo)
 {
     // packet_list_store.c:packet_list_change_record(PacketList *packet_list, PacketListRecord *record, gint col, column_info *cinfo)
@@ -210,74 +260,15 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         return;
     }
 
-    if (col_text_) {
-        col_text_->clear();
-    } else {
-        col_text_ = new ColumnTextList;
+    if (cinfo->num_cols > col_text_alloc_) {
+        col_text_ = (guint32 *) wmem_realloc(wmem_file_scope(), col_text_, cinfo->num_cols * sizeof(guint32));
+        col_text_alloc_ = cinfo->num_cols;
     }
+    col_text_len_ = 0;
     lines_ = 1;
     line_count_changed_ = false;
 
     for (int column = 0; column < cinfo->num_cols; ++column) {
-        int col_lines = 1;
-
-#ifdef MINIMIZE_STRING_COPYING
-        int text_col = cinfo_column_.value(column, -1);
-
-        /* Column based on frame_data or it already contains a value */
-        if (text_col < 0) {
-            col_fill_in_frame_data(fdata_, cinfo, column, FALSE);
-            col_text_->append(cinfo->columns[column].col_data);
-            continue;
-        }
-
-        switch (cinfo->col_fmt[column]) {
-        case COL_PROTOCOL:
-        case COL_INFO:
-        case COL_IF_DIR:
-        case COL_DCE_CALL:
-        case COL_8021Q_VLAN_ID:
-        case COL_EXPERT:
-        case COL_FREQ_CHAN:
-            if (cinfo->columns[column].col_data && cinfo->columns[column].col_data != cinfo->columns[column].col_buf) {
-                /* This is a constant string, so we don't have to copy it */
-                // XXX - ui/gtk/packet_list_store.c uses G_MAXUSHORT. We don't do proper UTF8
-                // truncation in either case.
-                int col_text_len = MIN(qstrlen(cinfo->col_data[column]) + 1, COL_MAX_INFO_LEN);
-                col_text_->append(QByteArray::fromRawData(cinfo->columns[column].col_data, col_text_len));
-                break;
-            }
-            /* !! FALL-THROUGH!! */
-
-        case COL_DEF_SRC:
-        case COL_RES_SRC:        /* COL_DEF_SRC is currently just like COL_RES_SRC */
-        case COL_UNRES_SRC:
-        case COL_DEF_DL_SRC:
-        case COL_RES_DL_SRC:
-        case COL_UNRES_DL_SRC:
-        case COL_DEF_NET_SRC:
-        case COL_RES_NET_SRC:
-        case COL_UNRES_NET_SRC:
-        case COL_DEF_DST:
-        case COL_RES_DST:        /* COL_DEF_DST is currently just like COL_RES_DST */
-        case COL_UNRES_DST:
-        case COL_DEF_DL_DST:
-        case COL_RES_DL_DST:
-        case COL_UNRES_DL_DST:
-        case COL_DEF_NET_DST:
-        case COL_RES_NET_DST:
-        case COL_UNRES_NET_DST:
-        default:
-            if (!get_column_resolved(column) && cinfo->col_expr.col_expr_val[column]) {
-                /* Use the unresolved value in col_expr_val */
-                // XXX Use QContiguousCache?
-                col_text_->append(cinfo->col_expr.col_expr_val[column]);
-            } else {
-                col_text_->append(cinfo->columns[column].col_data);
-            }
-            break;
-        }
-#else // MINIMIZE_STRING_COPYING
         const char *col_str;
         if (!get_column_resolved(column) && cinfo->col_expr.col_expr_val[column]) {
             /* Use the unresolved value in col_expr_val */
@@ -290,20 +281,15 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
             }
             col_str = cinfo->columns[column].col_data;
         }
-        // g_string_chunk_insert_const manages a hash table of pointers to
-        // strings:
-        // https://git.gnome.org/browse/glib/tree/glib/gstringchunk.c
-        // We might be better off adding the equivalent functionality to
-        // wmem_tree.
-        col_text_->append(g_string_chunk_insert_const(string_pool_, col_str));
-        for (int i = 0; col_str[i]; i++) {
-            if (col_str[i] == '\n') col_lines++;
-        }
+
+        guint32 id = internString(col_str);
+        col_text_[col_text_len_++] = id;
+
+        int col_lines = g_array_index(string_pool_entries_, StringPoolEntry, id).lines;
         if (col_lines > lines_) {
             lines_ = col_lines;
             line_count_changed_ = true;
         }
-#endif // MINIMIZE_STRING_COPYING
     }
 }
 
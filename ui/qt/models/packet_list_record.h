@@ -24,8 +24,8 @@
 
 struct conversation;
 struct _GStringChunk;
-
-class ColumnTextList;
+struct _GHashTable;
+struct _GArray;
 
 class PacketListRecord
 {
@@ -37,7 +37,11 @@ public:
     static void operator delete(void *) {}
 
     // Return the string value for a column. Data is cached if possible.
+    // The array doesn't own its data, which is only valid until the column
+    // strings are invalidated.
     const QByteArray columnString(capture_file *cap_file, int column, bool colorized = false);
+    // The same as a C string. May return NULL.
+    const char *columnText(capture_file *cap_file, int column, bool colorized = false);
     frame_data *frameData() const { return fdata_; }
     // packet_list->col_to_text in gtk/packet_list_store.c
     static int textColumn(int column) { return cinfo_column_.value(column, -1); }
@@ -45,17 +49,22 @@ public:
     struct conversation *conversation() { return conv_; }
 
     int columnTextSize(const char *str);
-    static void invalidateAllRecords() { col_data_ver_++; }
+    static void invalidateAllRecords();
     static void resetColumns(column_info *cinfo);
     void resetColorized();
     inline int lineCount() { return lines_; }
     inline int lineCountChanged() { return line_count_changed_; }
 
     static void clearStringPool();
+    // Keep column text pointers valid across invalidations until released.
+    static void holdStringPool() { string_pool_holds_++; }
+    static void releaseStringPool() { string_pool_holds_--; }
 
 private:
-    /** The column text for some columns */
-    ColumnTextList *col_text_;
+    /** The column text, as string pool IDs */
+    guint32 *col_text_;
+    int col_text_len_;
+    int col_text_alloc_;
 
     frame_data *fdata_;
     int lines_;
@@ -74,7 +83,16 @@ private:
     void dissect(capture_file *cap_file, bool dissect_color = false);
     void cacheColumnStrings(column_info *cinfo);
 
+    struct StringPoolEntry {
+        const char *str;
+        int lines;
+    };
+    static guint32 internString(const char *str);
+
     static struct _GStringChunk *string_pool_;
+    static struct _GHashTable *string_pool_ids_;
+    static struct _GArray *string_pool_entries_;
+    static int string_pool_holds_;
 
 };
 
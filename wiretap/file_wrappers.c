@@ -1060,10 +1060,15 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
      * outside the span for compressed files or is this an uncompressed
      * file?
      *
-     * XXX, profile
+     * When seeking forward in a compressed file, only use the seek
+     * point if it's past the current position; if it isn't, jumping
+     * back to it means decompressing, again, the data between it and
+     * where we already are, and just skipping forward from here is
+     * cheaper.
      */
     if ((here = fast_seek_find(file, file->pos + offset)) &&
-        (offset < 0 || offset > SPAN || here->compression == UNCOMPRESSED)) {
+        (offset < 0 || (offset > SPAN && here->out > file->pos) ||
+         here->compression == UNCOMPRESSED)) {
         gint64 off, off2;
 
         /*
@@ -1313,6 +1318,33 @@ file_read(void *buf, unsigned int len, FILE_T file)
                we're at the end of the input; just return
                with what we've gotten so far. */
             break;
+        } else if (file->compression == UNCOMPRESSED && buf != NULL &&
+                   len >= file->size) {
+            /* We have nothing in the output buffer, the file
+               isn't compressed, and we want at least a buffer's
+               worth of data; read it directly into buf, rather
+               than reading it into the output buffer and then
+               copying it from there. */
+            ssize_t ret;
+
+            /* The output buffer no longer holds the data just
+               before the current position, so don't let a
+               backwards seek land in it. */
+            buf_reset(&file->out);
+            ret = ws_read(file->fd, buf, len);
+            if (ret < 0) {
+                file->err = errno;
+                file->err_info = NULL;
+                return -1;
+            }
+            if (ret == 0)
+                file->eof = TRUE;
+            n = (guint)ret;
+            buf = (char *)buf + n;
+            len -= n;
+            got += n;
+            file->pos += n;
+            file->raw_pos += n;
         } else {
             /* We have nothing in the output buffer, and
                we can generate more data; get more output,
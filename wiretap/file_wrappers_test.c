@@ -0,0 +1,107 @@
+/* file_wrappers_test.c
+ * Standalone program to test the FILE_T reading and seeking routines
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include <wsutil/file_util.h>
+
+#include "file_wrappers.h"
+
+/* Big enough that reads of READ_LEN bytes bypass the FILE_T buffers. */
+#define FILE_LEN (4 * 1024 * 1024)
+#define READ_LEN (1024 * 1024)
+
+static gchar *test_file_name;
+
+/* Contents of the test file at a given offset; doesn't repeat with any
+ * power-of-two period, so stale buffer contents don't match by accident. */
+static guint8
+test_file_byte(gint64 offset)
+{
+    return (guint8)((offset * 7) ^ (offset >> 9) ^ (offset >> 17));
+}
+
+static void
+file_wrappers_test_seek_back_after_large_read(void)
+{
+    FILE_T   fh;
+    guint8  *buf;
+    gint64   pos;
+    int      err = 0;
+    int      i;
+
+    fh = file_open(test_file_name);
+    g_assert(fh != NULL);
+    buf = (guint8 *)g_malloc(READ_LEN);
+
+    /* Fill the output buffer, then read past it directly into buf. */
+    g_assert_cmpint(file_read(buf, 100, fh), ==, 100);
+    g_assert_cmpint(file_read(buf, READ_LEN, fh), ==, READ_LEN);
+    pos = 100 + READ_LEN;
+    g_assert_cmpint(file_tell(fh), ==, pos);
+
+    /* A short seek backwards must give the bytes just read. */
+    g_assert_cmpint(file_seek(fh, -10, SEEK_CUR, &err), ==, pos - 10);
+    g_assert_cmpint(err, ==, 0);
+    g_assert_cmpint(file_read(buf, 20, fh), ==, 20);
+    for (i = 0; i < 20; i++)
+        g_assert_cmpuint(buf[i], ==, test_file_byte(pos - 10 + i));
+
+    file_close(fh);
+    g_free(buf);
+}
+
+int
+main(int argc, char **argv)
+{
+    GError *error = NULL;
+    guint8 *contents;
+    gint64  i;
+    int     fd, result;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/file_wrappers/seek/back_after_large_read",
+            file_wrappers_test_seek_back_after_large_read);
+
+    fd = g_file_open_tmp("file_wrappers_test_XXXXXX", &test_file_name, &error);
+    g_assert_no_error(error);
+    ws_close(fd);
+    contents = (guint8 *)g_malloc(FILE_LEN);
+    for (i = 0; i < FILE_LEN; i++)
+        contents[i] = test_file_byte(i);
+    g_file_set_contents(test_file_name, (const gchar *)contents, FILE_LEN, &error);
+    g_assert_no_error(error);
+    g_free(contents);
+
+    result = g_test_run();
+
+    ws_unlink(test_file_name);
+    g_free(test_file_name);
+
+    return result;
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -201,21 +201,106 @@ merge_select_frame_type(int in_file_count, merge_in_file_t in_files[])
 }
 
 /*
- * returns TRUE if first argument is earlier than second
+ * The files that have a record available, kept as a binary min-heap
+ * ordered by merge_in_file_is_earlier(), so that picking the next record
+ * is O(log N) in the number of files rather than O(N).
+ */
+typedef struct {
+    merge_in_file_t **files;
+    guint             count;
+    gboolean          primed;   /* we've tried to read from every file */
+    merge_in_file_t  *last;     /* file of the last record returned */
+} merge_heap_t;
+
+/*
+ * returns TRUE if the record available from the first file should be
+ * written before the one from the second file
+ *
+ * Records with no time stamp are treated as earlier than all other
+ * records, in file order.  Records with equal time stamps are taken
+ * from the file that comes last, as the linear search that this replaces
+ * did.
  */
 static gboolean
-is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
+merge_in_file_is_earlier(merge_in_file_t *l, merge_in_file_t *r)
 {
-    if (l->secs > r->secs) {  /* left is later */
-        return FALSE;
-    } else if (l->secs < r->secs) { /* left is earlier */
+    wtap_rec *l_rec = wtap_get_rec(l->wth);
+    wtap_rec *r_rec = wtap_get_rec(r->wth);
+
+    if (!(l_rec->presence_flags & WTAP_HAS_TS)) {
+        if (!(r_rec->presence_flags & WTAP_HAS_TS))
+            return l < r;
         return TRUE;
-    } else if (l->nsecs > r->nsecs) { /* tv_sec equal, l.usec later */
+    }
+    if (!(r_rec->presence_flags & WTAP_HAS_TS))
         return FALSE;
+    if (l_rec->ts.secs != r_rec->ts.secs)
+        return l_rec->ts.secs < r_rec->ts.secs;
+    if (l_rec->ts.nsecs != r_rec->ts.nsecs)
+        return l_rec->ts.nsecs < r_rec->ts.nsecs;
+    return l > r;
+}
+
+static void
+merge_heap_push(merge_heap_t *heap, merge_in_file_t *in_file)
+{
+    guint i = heap->count++;
+
+    while (i > 0) {
+        guint parent = (i - 1) / 2;
+
+        if (!merge_in_file_is_earlier(in_file, heap->files[parent]))
+            break;
+        heap->files[i] = heap->files[parent];
+        i = parent;
     }
-    /* either one < two or one == two
-     * either way, return one
-     */
+    heap->files[i] = in_file;
+}
+
+static merge_in_file_t *
+merge_heap_pop(merge_heap_t *heap)
+{
+    merge_in_file_t *top = heap->files[0];
+    merge_in_file_t *last = heap->files[--heap->count];
+    guint i = 0;
+
+    for (;;) {
+        guint child = 2 * i + 1;
+
+        if (child >= heap->count)
+            break;
+        if (child + 1 < heap->count &&
+            merge_in_file_is_earlier(heap->files[child + 1], heap->files[child]))
+            child++;
+        if (!merge_in_file_is_earlier(heap->files[child], last))
+            break;
+        heap->files[i] = heap->files[child];
+        i = child;
+    }
+    if (heap->count > 0)
+        heap->files[i] = last;
+
+    return top;
+}
+
+/*
+ * Read a record from the given file, updating its state.  Returns FALSE
+ * on a read error.
+ */
+static gboolean
+merge_read_record(merge_in_file_t *in_file, int *err, gchar **err_info)
+{
+    gint64 data_offset;
+
+    if (!wtap_read(in_file->wth, err, err_info, &data_offset)) {
+        if (*err != 0) {
+            in_file->state = GOT_ERROR;
+            return FALSE;
+        }
+        in_file->state = AT_EOF;
+    } else
+        in_file->state = RECORD_PRESENT;
+
     return TRUE;
 }
 
@@ -231,6 +316,7 @@ is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
  * On an EOF (meaning all the files are at EOF), set *err to 0 and return
  * NULL.
  *
+ * @param heap merge state, with room for in_file_count files
  * @param in_file_count number of entries in in_files
  * @param in_files input file array
  * @param err wiretap error, if failed
@@ -240,78 +326,67 @@ is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
  * all files
  */
 static merge_in_file_t *
-merge_read_packet(int in_file_count, merge_in_file_t in_files[],
-                  int *err, gchar **err_info)
+merge_read_packet(merge_heap_t *heap, int in_file_count,
+                  merge_in_file_t in_files[], int *err, gchar **err_info)
 {
     int i;
-    int ei = -1;
-    nstime_t tv = { sizeof(time_t) > sizeof(int) ? LONG_MAX : INT_MAX, INT_MAX };
-    wtap_rec *rec;
+    merge_in_file_t *in_file = NULL;
 
-    /*
-     * Make sure we have a record available from each file that's not at
-     * EOF, and search for the record with the earliest time stamp or
-     * with no time stamp (those records are treated as earlier than
-     * all other records).  Yes, this means you won't get a chronological
-     * merge of those records, but you obviously *can't* get that.
-     */
-    for (i = 0; i < in_file_count; i++) {
-        gint64 data_offset;
-
-        if (in_files[i].state == RECORD_NOT_PRESENT) {
-            /*
-             * No packet available, and we haven't seen an error or EOF yet,
-             * so try to read the next packet.
-             */
-            if (!wtap_read(in_files[i].wth, err, err_info, &data_offset)) {
-                if (*err != 0) {
-                    in_files[i].state = GOT_ERROR;
-                    return &in_files[i];
-                }
-                in_files[i].state = AT_EOF;
-            } else
-                in_files[i].state = RECORD_PRESENT;
+    if (!heap->primed) {
+        /*
+         * Get the first record from each file, and put every file that
+         * has one on the heap.
+         */
+        for (i = 0; i < in_file_count; i++) {
+            if (in_files[i].state == RECORD_NOT_PRESENT &&
+                !merge_read_record(&in_files[i], err, err_info))
+                return &in_files[i];
+            if (in_files[i].state == RECORD_PRESENT)
+                merge_heap_push(heap, &in_files[i]);
         }
-
-        if (in_files[i].state == RECORD_PRESENT) {
-            rec = wtap_get_rec(in_files[i].wth);
-            if (!(rec->presence_flags & WTAP_HAS_TS)) {
-                /*
-                 * No time stamp.  Pick this record, and stop looking.
-                 */
-                ei = i;
-                break;
-            }
-            if (is_earlier(&rec->ts, &tv)) {
-                /*
-                 * This record's time stamp is earlier than any of the
-                 * records we've seen so far.  Pick it, for now, but
-                 * keep looking.
-                 */
-                tv = rec->ts;
-                ei = i;
-            }
+        heap->primed = TRUE;
+    } else if (heap->last != NULL) {
+        /*
+         * We need another record from the file we took the last one
+         * from.  If it's still earlier than the records of all the other
+         * files, as it is when the files don't overlap in time, take it
+         * right away without going through the heap.
+         */
+        in_file = heap->last;
+        heap->last = NULL;
+        if (!merge_read_record(in_file, err, err_info))
+            return in_file;
+        if (in_file->state != RECORD_PRESENT) {
+            in_file = NULL;
+        } else if (heap->count > 0 &&
+                   !merge_in_file_is_earlier(in_file, heap->files[0])) {
+            merge_heap_push(heap, in_file);
+            in_file = NULL;
         }
     }
 
-    if (ei == -1) {
-        /* All the streams are at EOF.  Return an EOF indication. */
-        *err = 0;
-        return NULL;
+    if (in_file == NULL) {
+        if (heap->count == 0) {
+            /* All the streams are at EOF.  Return an EOF indication. */
+            *err = 0;
+            return NULL;
+        }
+        in_file = merge_heap_pop(heap);
     }
 
     /* We'll need to read another packet from this file. */
-    in_files[ei].state = RECORD_NOT_PRESENT;
+    in_file->state = RECORD_NOT_PRESENT;
+    heap->last = in_file;
 
     /* Count this packet. */
-    in_files[ei].packet_num++;
+    in_file->packet_num++;
 
     /*
      * Return a pointer to the merge_in_file_t of the file from which the
      * packet was read.
      */
     *err = 0;
-    return &in_files[ei];
+    return in_file;
 }
 
 /** Read the next packet, in file sequence order, from the set of files
@@ -822,10 +897,16 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
 {
     merge_result        status = MERGE_OK;
     merge_in_file_t    *in_file;
+    merge_heap_t        heap;
     int                 count = 0;
     gboolean            stop_flag = FALSE;
     wtap_rec *rec,      snap_rec;
 
+    heap.files = g_new(merge_in_file_t *, in_file_count);
+    heap.count = 0;
+    heap.primed = FALSE;
+    heap.last = NULL;
+
     for (;;) {
         *err = 0;
 
@@ -834,7 +915,7 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
                                                err_info);
         }
         else {
-            in_file = merge_read_packet(in_file_count, in_files, err,
+            in_file = merge_read_packet(&heap, in_file_count, in_files, err,
                                         err_info);
         }
 
@@ -903,6 +984,8 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
         }
     }
 
+    g_free(heap.files);
+
     if (cb)
         cb->callback_func(MERGE_EVENT_DONE, count, in_files, in_file_count, cb->data);
 
@@ -15,8 +15,21 @@
 
 #include "config.h"
 
+/* See ws_mempbrk.c; older Mac OSX compilers have trouble with SSE4.2. */
+#ifdef __APPLE__
+#if defined(__clang__) && (__clang_major__ >= 6)
+#else
+#undef HAVE_SSE4_2
+#endif
+#endif
+
 #include <glib.h>
 #include <wsutil/crc32.h>
+#ifdef HAVE_SSE4_2
+#include <wsutil/ws_cpuid.h>
+#endif
+
+#include "crc32_int.h"
 
 #define CRC32_ACCUMULATE(c,d,table) (c=(c>>8)^(table)[(c^(d))&0xFF])
 
@@ -365,21 +378,107 @@ crc32_ccitt_table_lookup (guchar pos)
 	return crc32_ccitt_table[pos];
 }
 
-guint32
-crc32c_calculate(const void *buf, int len, guint32 crc)
+/*
+ * "Slicing-by-8" tables: crc32_slice_table[k][i] is the CRC of byte i
+ * followed by k zero bytes, so that the CRC of 8 bytes can be found
+ * with 8 independent lookups instead of a chain of 8 dependent ones.
+ * Row 0 is the byte-at-a-time table itself; the other rows are
+ * derived from it the first time they're needed.
+ */
+typedef guint32 crc32_slice_table[8][256];
+
+static crc32_slice_table crc32c_slice;
+static crc32_slice_table crc32_ccitt_slice;
+
+static void
+crc32_slice_table_init(crc32_slice_table slice, const guint32 *table)
 {
-	const guint8 *p = (const guint8 *)buf;
-	crc = CRC32C_SWAP(crc);
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
+	int i, k;
+
+	for (i = 0; i < 256; i++)
+		slice[0][i] = table[i];
+	for (k = 1; k < 8; k++) {
+		for (i = 0; i < 256; i++)
+			slice[k][i] = (slice[k-1][i] >> 8) ^ table[slice[k-1][i] & 0xFF];
 	}
-	return CRC32C_SWAP(crc);
 }
 
-guint32
-crc32c_calculate_no_swap(const void *buf, int len, guint32 crc)
+static void
+crc32_slice_tables_init(void)
+{
+	static gsize initialized = 0;
+
+	if (g_once_init_enter(&initialized)) {
+		crc32_slice_table_init(crc32c_slice, crc32c_table);
+		crc32_slice_table_init(crc32_ccitt_slice, crc32_ccitt_table);
+		g_once_init_leave(&initialized, 1);
+	}
+}
+
+/*
+ * Feed "len" bytes into a reflected CRC "crc" 8 bytes at a time.  The
+ * words are assembled from bytes explicitly, so this works on either
+ * byte order and for unaligned buffers.
+ */
+static guint32
+crc32_slice_by_8(crc32_slice_table slice, const guint8 *p, size_t len, guint32 crc)
+{
+	guint32 lo, hi;
+
+	crc32_slice_tables_init();
+
+	while (len >= 8) {
+		lo = crc ^ ((guint32)p[0] | (guint32)p[1] << 8 |
+		    (guint32)p[2] << 16 | (guint32)p[3] << 24);
+		hi = (guint32)p[4] | (guint32)p[5] << 8 |
+		    (guint32)p[6] << 16 | (guint32)p[7] << 24;
+		crc = slice[7][lo & 0xFF] ^ slice[6][(lo >> 8) & 0xFF] ^
+		    slice[5][(lo >> 16) & 0xFF] ^ slice[4][lo >> 24] ^
+		    slice[3][hi & 0xFF] ^ slice[2][(hi >> 8) & 0xFF] ^
+		    slice[1][(hi >> 16) & 0xFF] ^ slice[0][hi >> 24];
+		p += 8;
+		len -= 8;
+	}
+	while (len-- > 0)
+		CRC32_ACCUMULATE(crc, *p++, slice[0]);
+
+	return crc;
+}
+
+/*
+ * Short buffers aren't worth the table setup or the extra lookups;
+ * stay byte-at-a-time below this length.
+ */
+#define CRC32_SLICE_MIN_LEN	16
+
+#ifdef HAVE_SSE4_2
+static gboolean
+crc32c_use_sse42(void)
+{
+	/* cpuid is slow, only ask once */
+	static int use_sse42 = -1;
+
+	if (use_sse42 == -1)
+		use_sse42 = ws_cpuid_sse42() ? 1 : 0;
+
+	return use_sse42;
+}
+#endif
+
+static guint32
+crc32c_update(const guint8 *p, int len, guint32 crc)
 {
-	const guint8 *p = (const guint8 *)buf;
+	if (len <= 0)
+		return crc;
+
+#ifdef HAVE_SSE4_2
+	if (crc32c_use_sse42())
+		return crc32c_calculate_sse42(p, (size_t)len, crc);
+#endif
+
+	if (len >= CRC32_SLICE_MIN_LEN)
+		return crc32_slice_by_8(crc32c_slice, p, (size_t)len, crc);
+
 	while (len-- > 0) {
 		CRC32C(crc, *p++);
 	}
@@ -387,6 +486,20 @@ crc32c_calculate_no_swap(const void *buf, int len, guint32 crc)
 	return crc;
 }
 
+guint32
+crc32c_calculate(const void *buf, int len, guint32 crc)
+{
+	crc = CRC32C_SWAP(crc);
+	crc = crc32c_update((const guint8 *)buf, len, crc);
+	return CRC32C_SWAP(crc);
+}
+
+guint32
+crc32c_calculate_no_swap(const void *buf, int len, guint32 crc)
+{
+	return crc32c_update((const guint8 *)buf, len, crc);
+}
+
 guint32
 crc32_ccitt(const guint8 *buf, guint len)
 {
@@ -399,6 +512,9 @@ crc32_ccitt_seed(const guint8 *buf, guint len, guint32 seed)
 	guint i;
 	guint32 crc32 = seed;
 
+	if (len >= CRC32_SLICE_MIN_LEN)
+		return ~crc32_slice_by_8(crc32_ccitt_slice, buf, len, crc32);
+
 	for (i = 0; i < len; i++)
 		CRC32_ACCUMULATE(crc32, buf[i], crc32_ccitt_table);
 
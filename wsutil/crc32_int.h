@@ -0,0 +1,18 @@
+/* crc32_int.h
+ * Internal declarations of the accelerated CRC-32 kernels
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __CRC32_INT_H__
+#define __CRC32_INT_H__
+
+#ifdef HAVE_SSE4_2
+guint32 crc32c_calculate_sse42(const guint8 *buf, size_t len, guint32 crc);
+#endif
+
+#endif /* __CRC32_INT_H__ */
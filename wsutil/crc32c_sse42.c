@@ -0,0 +1,84 @@
+/* crc32c_sse42.c
+ * CRC-32C using the SSE4.2 crc32 instruction
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <nmmintrin.h>
+#include "crc32_int.h"
+
+/*
+ * The SSE4.2 crc32 instruction implements exactly the reflected
+ * Castagnoli polynomial of crc32c_table, without any pre- or
+ * post-conditioning, so this gives the same result as the table
+ * driven loop in crc32c_calculate_no_swap().
+ */
+guint32
+crc32c_calculate_sse42(const guint8 *buf, size_t len, guint32 crc)
+{
+    /* Byte at a time up to an 8 byte boundary */
+    while (len > 0 && ((gintptr)buf & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *buf++);
+        len--;
+    }
+
+#if defined(__x86_64__) || defined(_M_X64)
+    {
+        guint64 crc64 = crc;
+        guint64 word;
+
+        while (len >= 8) {
+            memcpy(&word, buf, sizeof word);
+            crc64 = _mm_crc32_u64(crc64, word);
+            buf += 8;
+            len -= 8;
+        }
+        crc = (guint32)crc64;
+    }
+#else
+    {
+        guint32 word;
+
+        while (len >= 4) {
+            memcpy(&word, buf, sizeof word);
+            crc = _mm_crc32_u32(crc, word);
+            buf += 4;
+            len -= 4;
+        }
+    }
+#endif
+
+    while (len > 0) {
+        crc = _mm_crc32_u8(crc, *buf++);
+        len--;
+    }
+
+    return crc;
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
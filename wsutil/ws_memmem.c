@@ -0,0 +1,94 @@
+/* ws_memmem.c
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+/* See ws_mempbrk.c; older Mac OSX compilers have trouble with SSE4.2. */
+#ifdef __APPLE__
+#if defined(__clang__) && (__clang_major__ >= 6)
+#else
+#undef HAVE_SSE4_2
+#endif
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include "ws_symbol_export.h"
+#include "ws_cpuid.h"
+#include "ws_memmem.h"
+#include "ws_memmem_int.h"
+
+const guint8 *
+ws_memmem_portable(const guint8 *haystack, size_t haystack_len, const guint8 *needle, size_t needle_len)
+{
+    const guint8 *begin = haystack;
+    const guint8 *last_possible;
+
+    if (needle_len > haystack_len)
+        return NULL;
+    last_possible = haystack + haystack_len - needle_len;
+
+    /* Let memchr() find the candidates, it's vectorized in most C libraries */
+    while (begin <= last_possible) {
+        begin = (const guint8 *)memchr(begin, needle[0], last_possible - begin + 1);
+        if (begin == NULL)
+            return NULL;
+        if (memcmp(begin + 1, needle + 1, needle_len - 1) == 0)
+            return begin;
+        begin++;
+    }
+
+    return NULL;
+}
+
+#ifdef HAVE_SSE4_2
+static gboolean
+ws_memmem_use_sse42(void)
+{
+    /* cpuid is slow, only ask once */
+    static int use_sse42 = -1;
+
+    if (use_sse42 == -1)
+        use_sse42 = ws_cpuid_sse42() ? 1 : 0;
+
+    return use_sse42;
+}
+#endif
+
+const guint8 *
+ws_memmem(const void *haystack, size_t haystack_len, const void *needle, size_t needle_len)
+{
+    if (needle_len == 0 || needle_len > haystack_len)
+        return NULL;
+
+    if (needle_len == 1)
+        return (const guint8 *)memchr(haystack, *(const guint8 *)needle, haystack_len);
+
+#ifdef HAVE_SSE4_2
+    /* The vector loop needs at least one full block */
+    if (haystack_len >= needle_len + 15 && ws_memmem_use_sse42())
+        return ws_memmem_sse42((const guint8 *)haystack, haystack_len, (const guint8 *)needle, needle_len);
+#endif
+
+    return ws_memmem_portable((const guint8 *)haystack, haystack_len, (const guint8 *)needle, needle_len);
+}
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
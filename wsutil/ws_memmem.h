@@ -0,0 +1,29 @@
+/* ws_memmem.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MEMMEM_H__
+#define __WS_MEMMEM_H__
+
+#include "ws_symbol_export.h"
+
+/** Find the first occurrence of a byte string in a buffer.
+ *
+ * Unlike memmem(), an empty needle is never found.
+ *
+ * @param haystack The data to search in.
+ * @param haystack_len The length of the data to search in.
+ * @param needle The byte string to search for.
+ * @param needle_len The length of the byte string.
+ * @return A pointer to the first occurrence of the needle in the
+ * haystack, or NULL if it isn't found.
+ */
+WS_DLL_PUBLIC const guint8 *ws_memmem(const void *haystack, size_t haystack_len,
+        const void *needle, size_t needle_len);
+
+#endif /* __WS_MEMMEM_H__ */
@@ -0,0 +1,19 @@
+/* ws_memmem_int.h
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MEMMEM_INT_H__
+#define __WS_MEMMEM_INT_H__
+
+const guint8 *ws_memmem_portable(const guint8 *haystack, size_t haystack_len, const guint8 *needle, size_t needle_len);
+
+#ifdef HAVE_SSE4_2
+const guint8 *ws_memmem_sse42(const guint8 *haystack, size_t haystack_len, const guint8 *needle, size_t needle_len);
+#endif
+
+#endif /* __WS_MEMMEM_INT_H__ */
@@ -0,0 +1,75 @@
+/* ws_memmem_sse42.c
+ * Substring search with SSE vector compares
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_SSE4_2
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <nmmintrin.h>
+#include "bits_ctz.h"
+#include "ws_memmem.h"
+#include "ws_memmem_int.h"
+
+/*
+ * Compare 16 possible start positions at a time: a position is only a
+ * candidate if both the first and the last byte of the needle match,
+ * which rules out nearly all positions in real data without looking
+ * at the bytes in between.  This is the "generic SIMD" algorithm
+ * described by Wojciech Mula at
+ * http://0x80.pl/articles/simd-strfind.html
+ *
+ * The caller makes sure that needle_len >= 2 and that
+ * haystack_len >= needle_len + 15.
+ */
+const guint8 *
+ws_memmem_sse42(const guint8 *haystack, size_t haystack_len, const guint8 *needle, size_t needle_len)
+{
+    const __m128i first = _mm_set1_epi8((char)needle[0]);
+    const __m128i last = _mm_set1_epi8((char)needle[needle_len - 1]);
+    size_t i;
+
+    for (i = 0; i + needle_len + 15 <= haystack_len; i += 16) {
+        const __m128i block_first = _mm_loadu_si128((const __m128i *)(const void *)(haystack + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i *)(const void *)(haystack + i + needle_len - 1));
+        guint32 mask = (guint32)_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                    _mm_cmpeq_epi8(last, block_last)));
+
+        while (mask != 0) {
+            int bit = ws_ctz(mask);
+
+            if (memcmp(haystack + i + bit + 1, needle + 1, needle_len - 2) == 0)
+                return haystack + i + bit;
+            mask &= mask - 1;
+        }
+    }
+
+    /* Fewer than 16 positions left */
+    return ws_memmem_portable(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+#endif /* HAVE_SSE4_2 */
+
+/*
+ * Editor modelines  -  http://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
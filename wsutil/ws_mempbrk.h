@@ -23,6 +23,7 @@ typedef struct {
 #ifdef HAVE_SSE4_2
     gboolean use_sse42;
     __m128i mask;
+    int mask_len;
 #endif
 } ws_mempbrk_pattern;
 